@@ -0,0 +1,251 @@
+#include "FileCache.h"
+#include "File.h"
+#include "HttpService.h"
+#include "Gzip.h"
+#include <glog/logging.h>
+#include <functional>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <sys/mman.h>
+
+// 判断缓存的条目与stat()得到的文件是否为同一版本
+static bool sameVersion(const FileCache::Entry & entry, const struct stat & st) {
+    // kGzip条目的size是编码后的大小，须与原文件的大小比较
+    return entry.fileSize == static_cast<size_t>(st.st_size)
+        && entry.modifyTime.tv_sec == st.st_mtim.tv_sec
+        && entry.modifyTime.tv_nsec == st.st_mtim.tv_nsec;
+}
+
+// 判断缓存的gzip条目所用的预压缩文件是否未被修改或删除
+static bool samePrecompressed(const FileCache::Entry & entry) {
+    if(!entry.precompressed) {
+        return true;
+    }
+    struct stat st;
+    return ::stat((entry.path + ".gz").c_str(), &st) == 0
+        && st.st_size == entry.gzipStatus.st_size
+        && st.st_mtim.tv_sec == entry.gzipStatus.st_mtim.tv_sec
+        && st.st_mtim.tv_nsec == entry.gzipStatus.st_mtim.tv_nsec;
+}
+
+// 解除文件的映射
+static void unmapFile(const void * addr, size_t size) {
+    ::munmap(const_cast<void *>(addr), size);
+}
+
+FileCache::FileCache(size_t capacity, LoadMode mode, size_t minFileSize, size_t maxFileSize)
+    : mode_(mode)
+    , shardCapacity_(capacity / kNumShards)
+    , minFileSize_(minFileSize)
+    , maxFileSize_(shardCapacity_ < maxFileSize ? shardCapacity_ : maxFileSize)
+    , shards_()
+    , hits_(0)
+    , misses_(0) {
+    for(int i = 0; i < kNumShards; ++i) {
+        shards_.emplace_back(new Shard);
+        shards_.back()->bytes = 0;
+    }
+}
+
+FileCache::~FileCache() {
+}
+
+bool FileCache::acceptable(const struct stat & st) const {
+    size_t size = st.st_size;
+    return S_ISREG(st.st_mode) && !(st.st_mode & S_IXUSR) && size >= minFileSize_ && size <= maxFileSize_;
+}
+
+FileCache::EntryPtr FileCache::get(const std::string & path, const struct stat & st) {
+    if(!acceptable(st)) {
+        return nullptr;
+    }
+
+    Shard & shard = shardOf(path);
+    {
+        MutexLockGuard lock(shard.mutex);
+        auto it = shard.index.find(path);
+        if(it != shard.index.end()) {
+            if(sameVersion(**it->second, st) && samePrecompressed(**it->second)) {
+                // 命中，移动到表头
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                ++hits_;
+                return *it->second;
+            }
+            // 文件（或预压缩文件）已被修改
+            eraseLocked(shard, it->second);
+        }
+    }
+
+    // 在锁外读取文件，避免阻塞同一分片上的其他请求
+    ++misses_;
+    EntryPtr entry = load(path);
+    if(!entry) {
+        return nullptr;
+    }
+
+    MutexLockGuard lock(shard.mutex);
+    auto it = shard.index.find(path);
+    if(it != shard.index.end()) {
+        // 其他线程已经加载了同一个文件
+        eraseLocked(shard, it->second);
+    }
+    shard.lru.push_front(entry);
+    shard.index[path] = shard.lru.begin();
+    shard.bytes += entry->size;
+    // 超出容量时淘汰最久未使用的条目
+    while(shard.bytes > shardCapacity_ && shard.lru.size() > 1) {
+        eraseLocked(shard, std::prev(shard.lru.end()));
+    }
+    return entry;
+}
+
+size_t FileCache::bytes() const {
+    size_t total = 0;
+    for(const auto & shard : shards_) {
+        MutexLockGuard lock(shard->mutex);
+        total += shard->bytes;
+    }
+    return total;
+}
+
+uint64_t FileCache::hits() const {
+    return hits_;
+}
+
+uint64_t FileCache::misses() const {
+    return misses_;
+}
+
+FileCache::EntryPtr FileCache::load(const std::string & path) {
+    File file(path);
+    if(!file.valid() || !acceptable(file.status())) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Entry> entry(std::make_shared<Entry>());
+    entry->path = path;
+    entry->fileSize = file.size();
+    entry->modifyTime = file.status().st_mtim;
+    entry->precompressed = false;
+    bool loaded = false;
+    switch(mode_) {
+        case kRead:
+            loaded = readFile(file, *entry);
+        break;
+
+        case kMmap:
+            loaded = mapFile(file, *entry);
+        break;
+
+        case kGzip:
+            loaded = loadGzip(file, *entry);
+        break;
+    }
+    if(!loaded) {
+        LOG(WARNING) << "Failed to load " << path << " into FileCache, the errno is " << errno << "(" << strerror(errno) << ")";
+        return nullptr;
+    }
+    entry->contentType = HttpService::getContentType(path);
+    entry->lastModified = HttpContext::formatHttpDate(entry->modifyTime.tv_sec);
+    if(mode_ == kGzip) {
+        // 同一资源的不同编码须使用不同的强ETag
+        entry->etag = HttpService::generateETag(entry->fileSize, entry->modifyTime, "gzip");
+        entry->headers = "Content-Type: " + entry->contentType + "\r\n"
+                       + "Content-Encoding: gzip\r\n";
+    } else {
+        entry->etag = HttpService::generateETag(entry->size, entry->modifyTime);
+        entry->headers = "Content-Type: " + entry->contentType + "\r\n";
+    }
+    entry->headers += "Content-Length: " + std::to_string(entry->size) + "\r\n"
+                    + "Last-Modified: " + entry->lastModified + "\r\n"
+                    + "ETag: " + entry->etag + "\r\n"
+                    + "Accept-Ranges: bytes\r\n";
+    if(Gzip::compressible(entry->contentType)) {
+        // 响应内容随Accept-Encoding变化，提示中间缓存区分对待
+        entry->headers += "Vary: Accept-Encoding\r\n";
+    }
+    return entry;
+}
+
+bool FileCache::readFile(const File & file, Entry & entry) {
+    std::shared_ptr<std::string> content(std::make_shared<std::string>(file.size(), '\0'));
+    size_t total = 0;
+    while(total < content->size()) {
+        ssize_t nBytes = ::pread(file.fd(), &(*content)[total], content->size() - total, total);
+        if(nBytes == -1 && errno == EINTR) {
+            continue;
+        } else if(nBytes <= 0) {
+            // 读取出错或文件被截断
+            if(nBytes == 0) {
+                errno = EIO;
+            }
+            return false;
+        }
+        total += nBytes;
+    }
+
+    entry.data = content->data();
+    entry.size = content->size();
+    entry.storage = content;
+    return true;
+}
+
+bool FileCache::mapFile(const File & file, Entry & entry) {
+    size_t size = file.size();
+    if(size == 0) {
+        // 长度为0的文件无法映射
+        entry.data = "";
+        entry.size = 0;
+        entry.storage = std::make_shared<char>('\0');
+        return true;
+    }
+
+    void * addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file.fd(), 0);
+    if(addr == MAP_FAILED) {
+        return false;
+    }
+    // 映射建立后即可关闭文件，最后一个引用者释放storage时解除映射
+    entry.data = static_cast<const char *>(addr);
+    entry.size = size;
+    entry.storage = std::shared_ptr<const void>(addr, std::bind(unmapFile, std::placeholders::_1, size));
+    return true;
+}
+
+bool FileCache::loadGzip(const File & file, Entry & entry) {
+    std::shared_ptr<File> precompressed(HttpService::openPrecompressed(file));
+    // 存在不早于原文件的预压缩文件时直接使用
+    if(precompressed) {
+        if(!readFile(*precompressed, entry)) {
+            return false;
+        }
+        entry.precompressed = true;
+        entry.gzipStatus = precompressed->status();
+        return true;
+    }
+
+    Entry original;
+    if(!readFile(file, original)) {
+        return false;
+    }
+    std::shared_ptr<std::string> content(std::make_shared<std::string>());
+    if(!Gzip::compress(original.data, original.size, content.get())) {
+        errno = EIO;
+        return false;
+    }
+
+    entry.data = content->data();
+    entry.size = content->size();
+    entry.storage = content;
+    return true;
+}
+
+FileCache::Shard & FileCache::shardOf(const std::string & path) {
+    return *shards_[std::hash<std::string>()(path) % kNumShards];
+}
+
+void FileCache::eraseLocked(Shard & shard, std::list<EntryPtr>::iterator it) {
+    shard.bytes -= (*it)->size;
+    shard.index.erase((*it)->path);
+    shard.lru.erase(it);
+}
@@ -0,0 +1,74 @@
+#include "Gzip.h"
+#include <zlib.h>
+#include <strings.h>
+#include <cctype>
+
+bool Gzip::compress(const char * data, size_t size, std::string * output, int level) {
+    z_stream stream;
+    bzero(&stream, sizeof(stream));
+    // windowBits加16表示输出gzip格式（而不是zlib格式）
+    if(deflateInit2(&stream, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    size_t offset = output->size();
+    output->resize(offset + deflateBound(&stream, size));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = size;
+    stream.next_out = reinterpret_cast<Bytef *>(&(*output)[offset]);
+    stream.avail_out = output->size() - offset;
+
+    // deflateBound()保证了输出空间足够，一次deflate()即可完成
+    int ret = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if(ret != Z_STREAM_END) {
+        output->resize(offset);
+        return false;
+    }
+    output->resize(offset + stream.total_out);
+    return true;
+}
+
+bool Gzip::accepted(boost::string_view acceptEncoding) {
+    // Accept-Encoding形如"gzip, deflate;q=0.5, br"，q=0表示不接受
+    boost::string_view::size_type pos = 0;
+    while(pos < acceptEncoding.size()) {
+        boost::string_view::size_type end = acceptEncoding.find(',', pos);
+        if(end == boost::string_view::npos) {
+            end = acceptEncoding.size();
+        }
+        boost::string_view::size_type begin = acceptEncoding.find_first_not_of(" \t", pos);
+        if(begin != boost::string_view::npos && begin < end) {
+            boost::string_view::size_type semicolon = acceptEncoding.find(';', begin);
+            boost::string_view::size_type nameEnd = semicolon < end ? semicolon : end;
+            boost::string_view::size_type last = acceptEncoding.find_last_not_of(" \t", nameEnd - 1);
+            boost::string_view coding(acceptEncoding.substr(begin, last - begin + 1));
+            if((coding.size() == 4 && strncasecmp(coding.data(), "gzip", 4) == 0) || coding == "*") {
+                if(semicolon >= end) {
+                    return true;
+                }
+                boost::string_view::size_type q = acceptEncoding.find("q=", semicolon);
+                if(q >= end) {
+                    return true;
+                }
+                // q值形如0、0.5、1.000，只要出现非0数字即大于0
+                for(q += 2; q < end && (isdigit(acceptEncoding[q]) || acceptEncoding[q] == '.'); ++q) {
+                    if(acceptEncoding[q] != '0' && acceptEncoding[q] != '.') {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+bool Gzip::compressible(const std::string & contentType) {
+    return contentType.compare(0, 5, "text/") == 0
+        || contentType.compare(0, 22, "application/javascript") == 0
+        || contentType.compare(0, 16, "application/json") == 0
+        || contentType.compare(0, 15, "application/xml") == 0
+        || contentType.compare(0, 13, "image/svg+xml") == 0;
+}
@@ -4,15 +4,35 @@
 #include "TcpConnection.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "HttpHeader.h"
+#include "File.h"
+#include "Gzip.h"
+#include "ByteScanner.h"
+#include "EventLoop.h"
+#include <glog/logging.h>
 #include <cassert>
 #include <cstring>
+#include <cstdio>
+#include <cctype>
+#include <strings.h>
+
+// 当前线程缓存的Date首部行，由startDateCache()启动的定时器每秒更新
+__thread char dateHeader[64];
+__thread size_t dateHeaderSize = 0;
+__thread bool dateCacheStarted = false;
 
 HttpContext::HttpContext(TcpConnectionPtr conn)
     : conn_(conn)
     , requestDecodeState_(kDecodeRequestDone)
-    , requestBodyEnd_(nullptr)
     , requestBodyRemainingSize_(0)
-    , responseBuffer_(new Buffer) {
+    , requestPinnedSize_(0)
+    , crlfScanOffset_(0)
+    , inputBuffer_(nullptr)
+    , responseBuffer_(new Buffer)
+    , readingPaused_(false)
+    , streamingResponse_(nullptr)
+    , chunkedStreaming_(false)
+    , closeAfterStreaming_(false) {
 }
 
 HttpContext::~HttpContext() {
@@ -23,61 +43,114 @@ HttpContext::TcpConnectionPtr HttpContext::getTcpConnection() const {
 }
 
 void HttpContext::process(BufferPtr message, TimeStamp received) {
+    // message是TcpConnection的接收缓冲，在连接（及HttpContext）的整个生命周期内有效
+    inputBuffer_ = message;
+    processRequests();
+}
+
+void HttpContext::processRequests() {
+    // 依次处理缓冲区中所有完整的请求（流水线），响应按请求的顺序合并到responseBuffer_中一起发送
+    while(conn_->connected() && !streamingResponse_) {
+        if(conn_->outputSize() >= kMaxPipelinedOutputSize) {
+            // 对端接收过慢，暂停读取和处理请求，等待写完成回调
+            pauseReading();
+            break;
+        }
+        resumeReading();
+        if(inputBuffer_->readableSize() == 0 || !processRequest()) {
+            break;
+        }
+        if(static_cast<size_t>(responseBuffer_->readableSize()) >= kMaxCoalescedSize) {
+            flushResponseBuffer();
+        }
+    }
+
+    flushResponseBuffer();
+    // responseBuffer_中的数据已被取走，释放其内存
+    responseBuffer_->shrink();
+}
+
+bool HttpContext::processRequest() {
     bool nullRequest = !static_cast<bool>(request_);
     bool requestHandled = requestDecodeState_ == kDecodeRequestDone || requestDecodeState_ == kDecodeRequestError;
     assert((nullRequest && requestHandled) || (!nullRequest && !requestHandled));
 
     if(!request_) {
         // request为nullptr，重启状态机
-        request_.reset(new HttpRequest);
-        requestDecodeState_ = kDecodeRequestLine;
+        // 优先复用上一个请求的对象，其内部的存储保留了容量
+        request_ = spareRequest_ ? std::move(spareRequest_) : std::make_shared<HttpRequest>();
+        requestDecodeState_ = kDecodeRequestHead;
+        crlfScanOffset_ = 0;
     }
 
     // 解码request
-    decodeHttpRequest(request_, message);
+    decodeHttpRequest(request_, inputBuffer_);
     if(requestDecodeState_ == kDecodeRequestError) {
         // 解析request出错，清空缓冲区
-        message->hasRead(message->readableSize());
+        inputBuffer_->hasRead(inputBuffer_->readableSize());
+        requestPinnedSize_ = 0;
         handleRequestError();
-        return ;
-    } else if(!requestDecodeState_ == kDecodeRequestDone) {
+        return false;
+    } else if(requestDecodeState_ != kDecodeRequestDone) {
         // 解析未全部完成
-        return ;
+        return false;
     }
 
 
     // 处理请求完毕后是否关闭连接
-    // FIXME ignore case?
-    const auto & connection = request_->getHeader("Connection");
-    bool closeAfterService = !connection.empty() && connection == "close";
+    bool closeAfterService = HttpHeader::equals(request_->getHeader(HttpHeader::kConnection), "close");
 
     // 处理请求
     if(serviceCallback_) {
         try {
-            response_.reset(new HttpResponse);
+            response_ = spareResponse_ ? std::move(spareResponse_) : std::make_shared<HttpResponse>();
             serviceCallback_(request_, response_);
         } catch(...) {
             // 处理请求过程中出错
             handleProcessError();
-            return ;
+            return false;
         }
     } else {
         // 没有设置request的处理函数
         handleProcessError();
-        return ;
+        return false;
     }
 
     // 编码response
-    encodeHttpResponse(response_, responseBuffer_.get());
-    // 发送response
-    conn_->send(responseBuffer_.get());
-    // 释放request
-    request_.reset();
+    bool streaming = static_cast<bool>(response_->chunkProvider());
+    if(streaming) {
+        // HTTP/1.0不支持chunked编码，以关闭连接表示响应体结束
+        chunkedStreaming_ = request_->version() == HttpVersion::kHttp11;
+        closeAfterService = closeAfterService || !chunkedStreaming_;
+        if(chunkedStreaming_) {
+            response_->setHeader("Transfer-Encoding", "chunked");
+        } else {
+            response_->setHeader("Connection", "close");
+        }
+    } else {
+        compressHttpResponse(request_, response_);
+    }
+    sendHttpResponse(response_);
+    if(streaming) {
+        streamingResponse_ = std::move(response_);
+    }
+    releaseRequest();
+
+    if(streaming) {
+        // 响应体发送完毕之前暂停读取，后续请求留在缓冲区中，避免其响应插入到响应体中间
+        closeAfterStreaming_ = closeAfterService;
+        pauseReading();
+        sendNextChunks();
+        return true;
+    }
 
     // 关闭连接
     if(closeAfterService) {
+        flushResponseBuffer();
         conn_->shutdown();
+        return false;
     }
+    return true;
 }
 
 void HttpContext::setServiceCallback(ServiceCallback callback) {
@@ -86,251 +159,558 @@ void HttpContext::setServiceCallback(ServiceCallback callback) {
 
 const char * HttpContext::findCRLF(BufferPtr message) {
     const char * begin = message->readBegin();
-    ssize_t size = message->readableSize();
-    const char * end = begin + size;
-
-    for(const char * it = begin; it != end; ++it) {
-        if(*it == '\r' && it + 1 < end && *(it + 1) == '\n') {
+    const char * end = begin + message->readableSize();
+
+    // 从上次查找停止的位置继续，不重复扫描已经检查过的数据
+    const char * it = begin + crlfScanOffset_;
+    while((it = ByteScanner::find(it, end, '\r')) != nullptr) {
+        if(it + 1 == end) {
+            // '\r'是最后一个字节，下次从它开始查找
+            break;
+        } else if(*(it + 1) == '\n') {
+            crlfScanOffset_ = 0;
             return it;
         }
+        ++it;
     }
 
+    crlfScanOffset_ = (it == nullptr ? end : it) - begin;
     return nullptr;
 }
 
-const char * HttpContext::findSpace(BufferPtr message) {
-    const char * begin = message->readBegin();
-    ssize_t size = message->readableSize();
-    const char * end = begin + size;
-
-    for(const char * it = begin; it != end; ++it) {
-        if(*it == ' ') {
+const char * HttpContext::findCRLF(const char * begin, const char * end) {
+    const char * it = begin;
+    while((it = ByteScanner::find(it, end, '\r')) != nullptr) {
+        if(it + 1 < end && *(it + 1) == '\n') {
             return it;
         }
+        ++it;
     }
-
     return nullptr;
 }
 
-const char * HttpContext::findColon(BufferPtr message) {
+const char * HttpContext::findHeadEnd(BufferPtr message) {
     const char * begin = message->readBegin();
-    ssize_t size = message->readableSize();
-    const char * end = begin + size;
-
-    for(const char * it = begin; it != end; ++it) {
-        if(*it == ':' && it + 1 < end && *(it + 1) == ' ') {
-            return it;
+    const char * end = begin + message->readableSize();
+
+    // 与findCRLF()相同，从上次查找停止的位置继续
+    const char * it = begin + crlfScanOffset_;
+    while((it = ByteScanner::find(it, end, '\r')) != nullptr) {
+        if(end - it < 4) {
+            // 剩余数据不足以判断，下次从这里开始查找
+            break;
+        } else if(memcmp(it, "\r\n\r\n", 4) == 0) {
+            crlfScanOffset_ = 0;
+            return it + 4;
         }
+        ++it;
     }
 
+    crlfScanOffset_ = (it == nullptr ? end : it) - begin;
     return nullptr;
 }
 
-const char * HttpContext::findQuestionMark(BufferPtr message) {
-    const char * begin = message->readBegin();
-    ssize_t size = message->readableSize();
-    const char * end = begin + size;
+bool HttpContext::parseRequestHead(HttpRequestPtr request, const char * begin, const char * end) {
+    // 请求行
+    const char * lineEnd = findCRLF(begin, end);
 
-    for(const char * it = begin; it != end; ++it) {
-        if(*it == '?') {
-            return it;
+    // 方法
+    const char * methodEnd = findSpace(begin, lineEnd);
+    if(methodEnd == nullptr) {
+        // 没找到分隔的空格
+        return false;
+    }
+    request->setMethod(boost::string_view(begin, methodEnd - begin));
+    if(request->method() == HttpMethod::kInvalid) {
+        // 方法错误或不支持
+        return false;
+    }
+
+    // URL
+    const char * urlBegin = methodEnd + 1;
+    const char * urlEnd = findSpace(urlBegin, lineEnd);
+    if(urlEnd == nullptr) {
+        // 没找到分隔的空格
+        return false;
+    }
+    const char * questionMark = request->method() == HttpMethod::kGet ? findQuestionMark(urlBegin, urlEnd) : nullptr;
+    if(questionMark != nullptr) {
+        request->setPath(boost::string_view(urlBegin, questionMark - urlBegin));
+        request->setQuery(boost::string_view(questionMark + 1, urlEnd - questionMark - 1));
+    } else {
+        request->setPath(boost::string_view(urlBegin, urlEnd - urlBegin));
+    }
+
+    // HTTP版本
+    request->setVersion(boost::string_view(urlEnd + 1, lineEnd - urlEnd - 1));
+    if(request->version() == HttpVersion::kUnknown) {
+        // 协议错误或不支持
+        return false;
+    }
+
+    // 请求首部（请求头以空行结尾，每一行都能找到CRLF）
+    for(const char * lineBegin = lineEnd + 2; (lineEnd = findCRLF(lineBegin, end)) != lineBegin; lineBegin = lineEnd + 2) {
+        const char * colon = findColon(lineBegin, lineEnd);
+        if(colon == nullptr) {
+            // 首部行缺少冒号
+            return false;
         }
+        boost::string_view name(lineBegin, colon - lineBegin);
+        boost::string_view value(colon + 2, lineEnd - colon - 2);
+        HttpHeader::Id id = HttpHeader::lookup(name);
+        if(id == HttpHeader::kContentLength || id == HttpHeader::kTransferEncoding) {
+            // 重复的Content-Length或Transfer-Encoding取值不同时无法确定消息体的边界（可被用于请求走私），不能只取最后一个
+            boost::string_view previous = request->getHeader(id);
+            if(!previous.empty() && previous != value) {
+                return false;
+            }
+        }
+        request->setHeader(id, name, value);
     }
+    // 缺少首部
+    return !request->headers().empty();
+}
 
-    return nullptr;
+const char * HttpContext::findSpace(const char * begin, const char * end) {
+    return ByteScanner::find(begin, end, ' ');
 }
 
-void HttpContext::decodeHttpRequest(HttpRequestPtr request, BufferPtr message) {
-    if(requestDecodeState_ == kDecodeRequestLine) {
-        // 请求行
-        const char * lineBegin = message->readBegin();
-        const char * lineEnd = findCRLF(message);
-        if(lineEnd == nullptr) {
-            return;
+const char * HttpContext::findColon(const char * begin, const char * end) {
+    // 首部名称和值以": "分隔
+    const char * it = begin;
+    while((it = ByteScanner::find(it, end, ':')) != nullptr) {
+        if(it + 1 < end && *(it + 1) == ' ') {
+            return it;
         }
+        ++it;
+    }
+    return nullptr;
+}
 
-        // 方法
-        const char * begin = lineBegin;
-        const char * end = findSpace(message);
-        if(end == nullptr) {
-            // 没找到分隔的空格
-            requestDecodeState_ = kDecodeRequestError;
+const char * HttpContext::findQuestionMark(const char * begin, const char * end) {
+    return ByteScanner::find(begin, end, '?');
+}
+
+void HttpContext::decodeHttpRequest(HttpRequestPtr request, BufferPtr message) {
+    if(requestDecodeState_ == kDecodeRequestHead) {
+        // 等待完整的请求行和首部，然后一次解析，视图直接引用接收缓冲
+        const char * headEnd = findHeadEnd(message);
+        if(headEnd == nullptr) {
+            if(static_cast<size_t>(message->readableSize()) > kMaxRequestHeadSize) {
+                // 请求头过长
+                requestDecodeState_ = kDecodeRequestError;
+            }
             return;
         }
-        request->setMethod(begin, end);
-        message->hasRead(end - begin + 1);
-        if(request->method() == HttpMethod::kInvalid) {
-            // 方法错误或不支持
+        if(!parseRequestHead(request, message->readBegin(), headEnd)) {
             requestDecodeState_ = kDecodeRequestError;
             return;
         }
+        // 请求处理完毕之前不从接收缓冲中取走请求头
+        requestPinnedSize_ = headEnd - message->readBegin();
+        requestDecodeState_ = kDecodeRequestBody;
+    }
 
-        // URL
-        begin = end + 1;
-        end = findSpace(message);
-        if(end == nullptr) {
-            // 没找到分隔的空格
-            requestDecodeState_ = kDecodeRequestError;
+    if(requestDecodeState_ == kDecodeRequestBody) {
+        // 请求体
+        if(request->method() == HttpMethod::kGet) {
+            // GET没有请求体
+            requestDecodeState_ = kDecodeRequestDone;
             return;
         }
-        if(request->method() == HttpMethod::kPost) {
-            // POST
-            request->setPath(begin, end);
-            message->hasRead(end - begin + 1);
-        } else if(request->method() == HttpMethod::kGet) {
-            // GET
-            const char * it = findQuestionMark(message);
-            if(it != nullptr) {
-                request->setPath(begin, it);
-                request->setQuery(it + 1, end);
-            } else {
-                request->setPath(begin, end);
+
+        // POST
+        boost::string_view transferEncoding = request->getHeader(HttpHeader::kTransferEncoding);
+        boost::string_view contentLength = request->getHeader(HttpHeader::kContentLength);
+        if(!transferEncoding.empty()) {
+            // 只支持chunked编码，同时带有Content-Length的请求可能是请求走私，一律拒绝
+            if(!HttpHeader::equals(transferEncoding, "chunked") || !contentLength.empty()) {
+                requestDecodeState_ = kDecodeRequestError;
+                return;
+            }
+            requestDecodeState_ = kDecodeRequestChunkSize;
+        } else {
+            // POST必须包含Content-Length或Transfer-Encoding字段
+            if(contentLength.empty() || contentLength.size() > kMaxContentLengthDigits || contentLength.find_first_not_of("0123456789") != boost::string_view::npos) {
+                requestDecodeState_ = kDecodeRequestError;
+                return;
+            }
+            requestBodyRemainingSize_ = 0;
+            for(char c : contentLength) {
+                requestBodyRemainingSize_ = requestBodyRemainingSize_ * 10 + (c - '0');
+            }
+
+            if(message->readableSize() - requestPinnedSize_ >= static_cast<size_t>(requestBodyRemainingSize_)) {
+                // 请求体已经完整地在接收缓冲中，直接引用
+                request->setBody(boost::string_view(message->readBegin() + requestPinnedSize_, requestBodyRemainingSize_));
+                requestPinnedSize_ += requestBodyRemainingSize_;
+                requestBodyRemainingSize_ = 0;
+                requestDecodeState_ = kDecodeRequestDone;
+                return;
             }
-            message->hasRead(end - begin + 1);
+            requestDecodeState_ = kDecodeRequestContent;
         }
 
-        // HTTP版本
-        begin = end + 1;
-        end = lineEnd;
-        request->setVersion(begin, end);
-        message->hasRead(end - begin + 2);
-        if(request->version() == HttpVersion::kUnknown) {
-            // 协议错误或不支持
+        // 请求体跨越多次读取，接收缓冲可能被移动，须先将请求头拷贝出来，再逐步取走请求体
+        request->detach();
+        message->hasRead(requestPinnedSize_);
+        requestPinnedSize_ = 0;
+    }
+
+    if(requestDecodeState_ == kDecodeRequestContent) {
+        // 定长的请求体
+        const char * begin = message->readBegin();
+        ssize_t len = message->readableSize();
+        if(len > requestBodyRemainingSize_) {
+            len = requestBodyRemainingSize_;
+        }
+        if(!request->appendBody(begin, begin + len)) {
             requestDecodeState_ = kDecodeRequestError;
             return;
         }
+        message->hasRead(len);
+        requestBodyRemainingSize_ -= len;
 
-        requestDecodeState_ = kDecodeRequestHeaders;
+        if(requestBodyRemainingSize_ == 0) {
+            requestDecodeState_ = kDecodeRequestDone;
+        }
+        return;
     }
 
-    if(requestDecodeState_ == kDecodeRequestHeaders) {
-        // 请求首部
-        while(true) {
+    // chunked编码的请求体：每个分块为“十六进制长度[;扩展]CRLF 数据 CRLF”，以长度为0的分块和可选的trailer结束
+    while(true) {
+        if(requestDecodeState_ == kDecodeRequestChunkSize) {
             const char * lineBegin = message->readBegin();
             const char * lineEnd = findCRLF(message);
             if(lineEnd == nullptr) {
-                return;
-            }
-
-            if(lineBegin == lineEnd) {
-                // 空行
-                if(!request->headers().empty()) {
-                    message->hasRead(2);
-                    requestDecodeState_ = kDecodeRequestBody;
-                    break;
-                } else {
-                    // 缺少首部
-                    requestDecodeState_ = kDecodeRequestError;
-                    return;
-                }
-            } else {
-                // 首部行
-                const char *it = findColon(message);
-                if(it == nullptr) {
-                    // 首部行缺少冒号
+                if(static_cast<size_t>(message->readableSize()) > kMaxChunkSizeLine) {
                     requestDecodeState_ = kDecodeRequestError;
-                    return;
                 }
-                request->setHeader(std::string(lineBegin, it), std::string(it + 2, lineEnd));
-                message->hasRead(lineEnd - lineBegin + 2);
+                return;
             }
-        }
-    }
 
-    if(requestDecodeState_ == kDecodeRequestBody) {
-        // 请求体
-        if(request->method() == HttpMethod::kGet) {
-            // GET没有请求体
-            requestDecodeState_ = kDecodeRequestDone;
-        } else if(request->method() == HttpMethod::kPost) {
-            // POST
-            const char * begin = message->readBegin();
-            if(requestBodyEnd_ == nullptr) {
-                // 读取Content-Length字段
-                const auto & contentLength = request->getHeader("Content-Length");
-                if(contentLength.empty()) {
-                    // POST必须包含Content-Length字段
+            // 忽略分块扩展
+            const char * sizeEnd = static_cast<const char *>(memchr(lineBegin, ';', lineEnd - lineBegin));
+            if(sizeEnd == nullptr) {
+                sizeEnd = lineEnd;
+            }
+            while(sizeEnd > lineBegin && (*(sizeEnd - 1) == ' ' || *(sizeEnd - 1) == '\t')) {
+                --sizeEnd;
+            }
+            if(sizeEnd == lineBegin || static_cast<size_t>(sizeEnd - lineBegin) > kMaxChunkSizeDigits) {
+                requestDecodeState_ = kDecodeRequestError;
+                return;
+            }
+            ssize_t chunkSize = 0;
+            for(const char * it = lineBegin; it != sizeEnd; ++it) {
+                int digit = isdigit(*it) ? *it - '0' : (isxdigit(*it) ? tolower(*it) - 'a' + 10 : -1);
+                if(digit < 0) {
                     requestDecodeState_ = kDecodeRequestError;
                     return;
                 }
-                requestBodyRemainingSize_ = std::stol(contentLength);
-                requestBodyEnd_ = begin + requestBodyRemainingSize_;
+                chunkSize = chunkSize * 16 + digit;
             }
+            message->hasRead(lineEnd - lineBegin + 2);
 
+            requestBodyRemainingSize_ = chunkSize;
+            requestDecodeState_ = chunkSize == 0 ? kDecodeRequestChunkTrailer : kDecodeRequestChunkData;
+        } else if(requestDecodeState_ == kDecodeRequestChunkData) {
+            const char * begin = message->readBegin();
             ssize_t len = message->readableSize();
             if(len > requestBodyRemainingSize_) {
                 len = requestBodyRemainingSize_;
             }
-            request->appendBody(begin, begin + len);
+            if(!request->appendBody(begin, begin + len)) {
+                requestDecodeState_ = kDecodeRequestError;
+                return;
+            }
             message->hasRead(len);
             requestBodyRemainingSize_ -= len;
+            if(requestBodyRemainingSize_ > 0) {
+                return;
+            }
 
-            if(requestBodyRemainingSize_ == 0) {
-                requestBodyEnd_ = nullptr;
+            // 分块数据之后的CRLF
+            if(message->readableSize() < 2) {
+                return;
+            }
+            if(memcmp(message->readBegin(), crlf.data(), 2) != 0) {
+                requestDecodeState_ = kDecodeRequestError;
+                return;
+            }
+            message->hasRead(2);
+            requestDecodeState_ = kDecodeRequestChunkSize;
+        } else if(requestDecodeState_ == kDecodeRequestChunkTrailer) {
+            const char * lineBegin = message->readBegin();
+            const char * lineEnd = findCRLF(message);
+            if(lineEnd == nullptr) {
+                return;
+            }
+            message->hasRead(lineEnd - lineBegin + 2);
+            if(lineBegin == lineEnd) {
+                // 空行，请求体结束
                 requestDecodeState_ = kDecodeRequestDone;
+                return;
             }
+            // 忽略trailer中的首部
+        } else {
+            return;
         }
     }
 }
 
 void HttpContext::encodeHttpResponse(HttpResponsePtr response, BufferPtr message) {
-    // 版本号
-    const auto & version = getVersionMessage(response->version());
-    message->write(version.data(), version.size());
-    message->write(space.data(), space.size());
-    
-    // 状态码
-    std::string statusCode(std::to_string(static_cast<int>(response->statusCode())));
-    message->write(statusCode.data(), statusCode.size());
-    message->write(space.data(), space.size());
-
-    // 状态信息
-    const auto & statusMsg = response->statusMessage();
-    message->write(statusMsg.data(), statusMsg.size());
-    message->write(crlf.data(), crlf.size());
+    const std::string & statusLine = getStatusLine(response->version(), response->statusCode());
+    const auto & headers = response->headers();
+    const std::string * encodedHeaders = response->encodedHeaders();
+    // 服务函数没有设置时追加Date和Server首部
+    if(!dateCacheStarted) {
+        // 当前线程没有启动缓存，每次重新格式化
+        updateDateHeader();
+    }
+    bool appendDate = response->getHeader(HttpHeader::kDate).empty();
+    bool appendServer = response->getHeader(HttpHeader::kServer).empty();
+
+    // 计算总长度，只预留一次空间
+    size_t size = statusLine.size() + crlf.size();
+    if(appendDate) {
+        size += dateHeaderSize;
+    }
+    if(appendServer) {
+        size += serverHeader_.size();
+    }
+    for(const auto & header : headers) {
+        size += header.name.size() + colon.size() + header.value.size() + crlf.size();
+    }
+    if(encodedHeaders != nullptr) {
+        size += encodedHeaders->size();
+    }
+    message->ensure(size);
+
+    // 状态行
+    char * it = message->writeBegin();
+    it = static_cast<char *>(mempcpy(it, statusLine.data(), statusLine.size()));
+
+    // 缓存的Date和预先编码好的Server
+    if(appendDate) {
+        it = static_cast<char *>(mempcpy(it, dateHeader, dateHeaderSize));
+    }
+    if(appendServer) {
+        it = static_cast<char *>(mempcpy(it, serverHeader_.data(), serverHeader_.size()));
+    }
 
     // 首部
-    const auto & headers = response->headers();
     for(const auto & header : headers) {
-        const auto & key = header.first;
-        const auto & value = header.second;
+        it = static_cast<char *>(mempcpy(it, header.name.data(), header.name.size()));
+        it = static_cast<char *>(mempcpy(it, colon.data(), colon.size()));
+        it = static_cast<char *>(mempcpy(it, header.value.data(), header.value.size()));
+        it = static_cast<char *>(mempcpy(it, crlf.data(), crlf.size()));
+    }
 
-        message->write(key.data(), key.size());
-        message->write(colon.data(), colon.size());
-        message->write(value.data(), value.size());
-        message->write(crlf.data(), crlf.size());
+    // 预先编码好的首部
+    if(encodedHeaders != nullptr) {
+        it = static_cast<char *>(mempcpy(it, encodedHeaders->data(), encodedHeaders->size()));
     }
 
     // 空行
-    message->write(crlf.data(), crlf.size());
+    it = static_cast<char *>(mempcpy(it, crlf.data(), crlf.size()));
+    message->hasWritten(it - message->writeBegin());
+}
+
 
+void HttpContext::handleWriteComplete() {
+    if(streamingResponse_) {
+        sendNextChunks();
+    }
+    if(!streamingResponse_ && readingPaused_) {
+        // 响应体发送完毕或发送缓冲已经排空，继续处理暂停期间留在缓冲区中的请求
+        processRequests();
+    }
+}
+
+void HttpContext::compressHttpResponse(HttpRequestPtr request, HttpResponsePtr response) {
+    // 只压缩由response自身持有的完整响应体，文件、外部内存和分段响应体不做处理
+    if(response->statusCode() != HttpStatusCode::kOk || response->file() || response->bodyHolder() || !response->bodyRanges().empty()
+        || response->body().size() < Gzip::kMinCompressSize || !response->getHeader(HttpHeader::kContentEncoding).empty()
+        || !Gzip::compressible(response->getHeader(HttpHeader::kContentType))) {
+        return ;
+    }
+    response->setHeader("Vary", "Accept-Encoding");
+    if(!Gzip::accepted(request->getHeader(HttpHeader::kAcceptEncoding))) {
+        return ;
+    }
+
+    std::string compressed;
+    if(!Gzip::compress(response->body().data(), response->body().size(), &compressed) || compressed.size() >= response->body().size()) {
+        // 压缩失败或没有变小时发送原内容
+        return ;
+    }
+    response->setBody(compressed);
+    response->setHeader("Content-Encoding", "gzip");
+    response->setContentLength(compressed.size());
+}
+
+void HttpContext::sendHttpResponse(HttpResponsePtr response) {
+    // 状态行和首部
+    encodeHttpResponse(response, responseBuffer_.get());
 
     // 响应体
-    const auto & body = response->body();
-    if(!body.empty()) {
-        message->write(body.data(), body.size());
+    std::shared_ptr<File> file = response->file();
+    const char * body = response->bodyData();
+    size_t bodySize = response->bodySize();
+    const auto & ranges = response->bodyRanges();
+    if(!ranges.empty()) {
+        // multipart响应体：依次发送每个分段的头部和文件（或外部内存）中对应的区间，小块数据合并到responseBuffer_中一起发送
+        for(const auto & range : ranges) {
+            responseBuffer_->write(range.header.data(), range.header.size());
+            if(file) {
+                flushResponseBuffer();
+                conn_->sendFile(file->fd(), range.offset, range.length, file);
+            } else if(range.length < kMaxCopiedBodySize) {
+                responseBuffer_->write(body + range.offset, range.length);
+            } else {
+                flushResponseBuffer();
+                conn_->send(body + range.offset, range.length, response->bodyHolder());
+            }
+        }
+        const auto & trailer = response->bodyTrailer();
+        responseBuffer_->write(trailer.data(), trailer.size());
+    } else if(file) {
+        // 文件响应体使用sendfile()发送，由file保证文件在发送完毕前不被关闭
+        flushResponseBuffer();
+        conn_->sendFile(file->fd(), response->fileOffset(), response->fileLength(), file);
+    } else if(bodySize < kMaxCopiedBodySize) {
+        // 较小的响应体拷贝到首部之后，与后续的响应一起发送
+        responseBuffer_->write(body, bodySize);
+    } else {
+        // 较大的响应体由其持有者（或response）持有，发送缓冲中只引用而不拷贝
+        std::shared_ptr<const void> holder = response->bodyHolder();
+        flushResponseBuffer();
+        conn_->send(body, bodySize, holder ? holder : response);
     }
 }
 
+void HttpContext::flushResponseBuffer() {
+    if(responseBuffer_->readableSize() > 0) {
+        conn_->send(responseBuffer_.get());
+    }
+}
+
+void HttpContext::sendNextChunks() {
+    const auto & provider = streamingResponse_->chunkProvider();
+    // 待发送的数据达到上限后等待写完成回调，数据源的产出速度不会超过网络的发送速度
+    while(conn_->connected() && conn_->outputSize() + responseBuffer_->readableSize() < kMaxStreamingBufferedSize) {
+        std::shared_ptr<std::string> chunk(std::make_shared<std::string>());
+        bool more = false;
+        try {
+            more = provider(chunk.get());
+        } catch(...) {
+            // 响应首部已经发出，无法再返回错误响应，只能断开连接
+            LOG(ERROR) << "Something wrong when generate chunked response body in TcpConnection " << conn_->name();
+            streamingResponse_.reset();
+            responseBuffer_->hasRead(responseBuffer_->readableSize());
+            conn_->forceClose();
+            return ;
+        }
+
+        if(!chunk->empty()) {
+            if(chunkedStreaming_) {
+                // 分块大小（十六进制）
+                char sizeLine[32];
+                int length = snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", chunk->size());
+                responseBuffer_->write(sizeLine, length);
+            }
+            if(chunk->size() < kMaxCopiedBodySize) {
+                // 较小的分块合并到responseBuffer_中一起发送
+                responseBuffer_->write(chunk->data(), chunk->size());
+            } else {
+                flushResponseBuffer();
+                conn_->send(chunk->data(), chunk->size(), chunk);
+            }
+            if(chunkedStreaming_) {
+                responseBuffer_->write(crlf.data(), crlf.size());
+            }
+        }
+        if(!more) {
+            finishStreaming();
+            return ;
+        } else if(chunk->empty()) {
+            // 数据源违反约定，避免空转
+            LOG(WARNING) << "Empty chunk provided before the end of response body in TcpConnection " << conn_->name();
+            break;
+        }
+    }
+
+    flushResponseBuffer();
+    responseBuffer_->shrink();
+}
+
+void HttpContext::finishStreaming() {
+    if(chunkedStreaming_) {
+        // 最后一个分块（长度为0，没有trailer）
+        static const std::string lastChunk("0\r\n\r\n");
+        responseBuffer_->write(lastChunk.data(), lastChunk.size());
+    }
+    flushResponseBuffer();
+    responseBuffer_->shrink();
+    streamingResponse_.reset();
+
+    // 否则由processRequests()恢复读取并继续处理缓冲区中的请求
+    if(closeAfterStreaming_) {
+        conn_->shutdown();
+    }
+}
+
+void HttpContext::pauseReading() {
+    if(!readingPaused_) {
+        readingPaused_ = true;
+        conn_->stopRead();
+    }
+}
+
+void HttpContext::resumeReading() {
+    if(readingPaused_) {
+        readingPaused_ = false;
+        conn_->startRead();
+    }
+}
+
+void HttpContext::releaseRequest() {
+    // 服务函数没有保留request和response时，一次性清空后留给下一个请求复用，稳定状态下不再为它们分配内存
+    if(request_.use_count() == 1) {
+        request_->reset();
+        spareRequest_ = std::move(request_);
+    }
+    request_.reset();
+    if(response_.use_count() == 1) {
+        response_->reset();
+        spareResponse_ = std::move(response_);
+    }
+    response_.reset();
+
+    // 请求处理完毕，视图不再被使用，可以从接收缓冲中取走请求的数据了
+    inputBuffer_->hasRead(requestPinnedSize_);
+    requestPinnedSize_ = 0;
+}
 
 void HttpContext::handleRequestError() {
     assert(requestDecodeState_ == kDecodeRequestError);
 
     response_ = generalResponse(HttpStatusCode::kBadRequest);
-    encodeHttpResponse(response_, responseBuffer_.get());
-    conn_->send(responseBuffer_.get());
+    sendHttpResponse(response_);
+    flushResponseBuffer();
     conn_->shutdown();
 
-    request_.reset();
+    releaseRequest();
 }
 
 void HttpContext::handleProcessError() {
     response_ = generalResponse(HttpStatusCode::kInternalServerError);
-    encodeHttpResponse(response_, responseBuffer_.get());
-    conn_->send(responseBuffer_.get());
+    sendHttpResponse(response_);
+    flushResponseBuffer();
     conn_->shutdown();
 
-    request_.reset();
+    releaseRequest();
 }
 
 const std::string & HttpContext::getStatusMessage(HttpStatusCode statusCode) {
@@ -339,6 +719,43 @@ const std::string & HttpContext::getStatusMessage(HttpStatusCode statusCode) {
     return it->second;
 }
 
+const std::string & HttpContext::getStatusLine(HttpVersion version, HttpStatusCode statusCode) {
+    return statusLines_[statusLineIndex(version, statusCode)];
+}
+
+size_t HttpContext::statusLineIndex(HttpVersion version, HttpStatusCode statusCode) {
+    size_t index = 0;
+    switch(statusCode) {
+        case HttpStatusCode::kOk:                       index = 0;  break;
+        case HttpStatusCode::kPartialContent:           index = 1;  break;
+        case HttpStatusCode::kNotModified:              index = 2;  break;
+        case HttpStatusCode::kBadRequest:               index = 3;  break;
+        case HttpStatusCode::kForbidden:                index = 4;  break;
+        case HttpStatusCode::kNotFound:                 index = 5;  break;
+        case HttpStatusCode::kMethodNotAllowed:         index = 6;  break;
+        case HttpStatusCode::kRangeNotSatisfiable:      index = 7;  break;
+        case HttpStatusCode::kInternalServerError:      index = 8;  break;
+        case HttpStatusCode::kNotImplemented:           index = 9;  break;
+        case HttpStatusCode::kHttpVersionNotSupported:  index = 10; break;
+    }
+    // 未知版本按HTTP/1.1处理
+    return (version == HttpVersion::kHttp10 ? kNumStatusCodes : 0) + index;
+}
+
+std::vector<std::string> HttpContext::makeStatusLines() {
+    std::vector<std::string> statusLines(2 * kNumStatusCodes);
+    for(HttpVersion version : {HttpVersion::kHttp10, HttpVersion::kHttp11}) {
+        for(const auto & status : statusMessage_) {
+            char code[kMaxIntegerSize];
+            std::string & statusLine = statusLines[statusLineIndex(version, status.first)];
+            statusLine = getVersionMessage(version) + space;
+            statusLine.append(code, formatInteger(status.first, code));
+            statusLine += space + status.second + crlf;
+        }
+    }
+    return statusLines;
+}
+
 const std::string & HttpContext::getVersionMessage(HttpVersion version) {
     auto it = versionMessage_.find(version);
     assert(it != versionMessage_.cend());
@@ -363,13 +780,11 @@ HttpContext::HttpResponsePtr HttpContext::generalResponse(HttpStatusCode statusC
     response->setVersion(HttpVersion::kHttp11);
     response->setStatusCode(statusCode);
     response->setHeader("Content-Type", "text/html;charset=utf-8");
-    // FIXME 改为动态获取程序名和版本号
-    response->setHeader("Server", "tinyserver/1.2.1");
 
     std::string msg(std::to_string(static_cast<int>(response->statusCode())) + " " + response->statusMessage());
-    response->setBody("<html><head><title>" + msg + "</title></head><body><center><h1>" + msg + "</h1></center><hr><center>tinyserver/1.2.1</center></body></html>");
+    response->setBody("<html><head><title>" + msg + "</title></head><body><center><h1>" + msg + "</h1></center><hr><center>" + serverName_ + "</center></body></html>");
 
-    response->setHeader("Content-Length", std::to_string(response->body().size()));
+    response->setContentLength(response->body().size());
     // FIXME close or keep-alive?
     response->setHeader("Connection", "close");
 
@@ -385,22 +800,78 @@ HttpContext::HttpResponsePtr HttpContext::simpleResponse(HttpVersion version, Ht
     response->setVersion(version);
     response->setStatusCode(statusCode);
     response->setHeader("Content-Type", "text/html;charset=utf-8");
-    // FIXME 改为动态获取程序名和版本号
-    response->setHeader("Server", "tinyserver/1.2.1");
 
-    response->setBody("<html><head><title>" + title + "</title></head><body><p>" + content + "</p><hr><center>tinyserver/1.2.1</center></body></html>");
+    response->setBody("<html><head><title>" + title + "</title></head><body><p>" + content + "</p><hr><center>" + serverName_ + "</center></body></html>");
 
-    response->setHeader("Content-Length", std::to_string(response->body().size()));
+    response->setContentLength(response->body().size());
 
     return response;
 }
 
+size_t HttpContext::formatInteger(uint64_t value, char * buf) {
+    // 从低位向高位写入临时空间，再整体拷贝
+    char digits[kMaxIntegerSize];
+    char * it = digits + kMaxIntegerSize;
+    do {
+        *--it = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while(value != 0);
+    size_t length = digits + kMaxIntegerSize - it;
+    memcpy(buf, it, length);
+    return length;
+}
+
+void HttpContext::startDateCache(EventLoop * loop) {
+    loop->assertInLoopThread();
+    updateDateHeader();
+    dateCacheStarted = true;
+    loop->runEvery(1.0, std::bind(&HttpContext::updateDateHeader));
+}
+
+void HttpContext::setServerName(const std::string & name) {
+    serverName_ = name;
+    serverHeader_ = HttpHeader::name(HttpHeader::kServer) + colon + name + crlf;
+}
+
+const std::string & HttpContext::serverName() {
+    return serverName_;
+}
+
+void HttpContext::updateDateHeader() {
+    std::string date(HttpHeader::name(HttpHeader::kDate) + colon + formatHttpDate(::time(nullptr)) + crlf);
+    assert(date.size() <= sizeof(dateHeader));
+    memcpy(dateHeader, date.data(), date.size());
+    dateHeaderSize = date.size();
+}
+
+std::string HttpContext::formatHttpDate(time_t time) {
+    struct tm tm;
+    gmtime_r(&time, &tm);
+    char buf[32];
+    size_t len = strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return std::string(buf, len);
+}
+
+bool HttpContext::parseHttpDate(const std::string & date, time_t * time) {
+    struct tm tm;
+    bzero(&tm, sizeof(tm));
+    const char * end = strptime(date.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    if(end == nullptr || *end != '\0') {
+        return false;
+    }
+    *time = timegm(&tm);
+    return true;
+}
+
 const std::unordered_map<HttpContext::HttpStatusCode, std::string> HttpContext::statusMessage_ {
     {HttpStatusCode::kOk,                       "OK"                        },
+    {HttpStatusCode::kPartialContent,           "Partial Content"           },
+    {HttpStatusCode::kNotModified,              "Not Modified"              },
     {HttpStatusCode::kBadRequest,               "Bad Request"               },
     {HttpStatusCode::kForbidden,                "Forbidden"                 },
     {HttpStatusCode::kNotFound,                 "Not Found"                 },
     {HttpStatusCode::kMethodNotAllowed,         "Method Not Allowed"        },
+    {HttpStatusCode::kRangeNotSatisfiable,      "Range Not Satisfiable"     },
     {HttpStatusCode::kInternalServerError,      "Internal Server Error"     },
     {HttpStatusCode::kNotImplemented,           "Not Implemented"           },
     {HttpStatusCode::kHttpVersionNotSupported,  "HTTP Version Not Supported"}
@@ -421,3 +892,9 @@ std::unordered_map<HttpContext::HttpStatusCode, HttpContext::HttpResponsePtr> Ht
 const std::string HttpContext::crlf {"\r\n"};
 const std::string HttpContext::space {" "};
 const std::string HttpContext::colon {": "};
+
+// 依赖statusMessage_、versionMessage_和上面的分隔符，须定义在它们之后
+const std::vector<std::string> HttpContext::statusLines_ {HttpContext::makeStatusLines()};
+
+std::string HttpContext::serverName_ {kDefaultServerName};
+std::string HttpContext::serverHeader_ {"Server: " + serverName_ + "\r\n"};
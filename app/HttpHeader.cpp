@@ -0,0 +1,75 @@
+#include "HttpHeader.h"
+#include <cassert>
+#include <strings.h>
+
+// 由名称长度和小写的首字母组成的查找键
+static constexpr int lookupKey(size_t length, char first) {
+    return static_cast<int>(length << 8) | static_cast<unsigned char>(first);
+}
+
+HttpHeader::Id HttpHeader::lookup(boost::string_view name) {
+    if(name.empty()) {
+        return kUnknown;
+    }
+    // 常用首部的长度和首字母（不区分大小写）的组合各不相同，先据此确定唯一的候选，再比较一次完整名称
+    // 首字母或上0x20将ASCII大写字母转为小写，其他字符转换后即使命中了候选，也会在比较完整名称时被排除
+    Id candidate;
+    switch(lookupKey(name.size(), name[0] | 0x20)) {
+        case lookupKey(4, 'd'):     candidate = kDate;              break;
+        case lookupKey(4, 'e'):     candidate = kETag;              break;
+        case lookupKey(4, 'h'):     candidate = kHost;              break;
+        case lookupKey(4, 'v'):     candidate = kVary;              break;
+        case lookupKey(5, 'r'):     candidate = kRange;             break;
+        case lookupKey(6, 'a'):     candidate = kAccept;            break;
+        case lookupKey(6, 's'):     candidate = kServer;            break;
+        case lookupKey(8, 'i'):     candidate = kIfRange;           break;
+        case lookupKey(10, 'c'):    candidate = kConnection;        break;
+        case lookupKey(10, 'u'):    candidate = kUserAgent;         break;
+        case lookupKey(12, 'c'):    candidate = kContentType;       break;
+        case lookupKey(13, 'a'):    candidate = kAcceptRanges;      break;
+        case lookupKey(13, 'c'):    candidate = kContentRange;      break;
+        case lookupKey(13, 'i'):    candidate = kIfNoneMatch;       break;
+        case lookupKey(13, 'l'):    candidate = kLastModified;      break;
+        case lookupKey(14, 'c'):    candidate = kContentLength;     break;
+        case lookupKey(15, 'a'):    candidate = kAcceptEncoding;    break;
+        case lookupKey(16, 'c'):    candidate = kContentEncoding;   break;
+        case lookupKey(17, 'i'):    candidate = kIfModifiedSince;   break;
+        case lookupKey(17, 't'):    candidate = kTransferEncoding;  break;
+        default:                    return kUnknown;
+    }
+    return equals(name, names_[candidate]) ? candidate : kUnknown;
+}
+
+const std::string & HttpHeader::name(Id id) {
+    assert(id > kUnknown && id < kNumKnownHeaders);
+    return names_[id];
+}
+
+bool HttpHeader::equals(boost::string_view lhs, boost::string_view rhs) {
+    return lhs.size() == rhs.size() && strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+// 顺序须与Id一致，增加首部时须同时在lookup()中加入对应的长度和首字母
+const std::string HttpHeader::names_[kNumKnownHeaders] {
+    "",
+    "Accept",
+    "Accept-Encoding",
+    "Accept-Ranges",
+    "Connection",
+    "Content-Encoding",
+    "Content-Length",
+    "Content-Range",
+    "Content-Type",
+    "Date",
+    "ETag",
+    "Host",
+    "If-Modified-Since",
+    "If-None-Match",
+    "If-Range",
+    "Last-Modified",
+    "Range",
+    "Server",
+    "Transfer-Encoding",
+    "User-Agent",
+    "Vary"
+};
@@ -1,12 +1,22 @@
 #include "HttpRequest.h"
+#include <glog/logging.h>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 HttpRequest::HttpRequest()
     : method_(HttpMethod::kInvalid)
-    , version_(HttpVersion::kUnknown) {
+    , version_(HttpVersion::kUnknown)
+    , bodySize_(0)
+    , bodyFile_(-1)
+    , detached_(false) {
 }
 
 HttpRequest::~HttpRequest() {
+    closeBodyFile();
 }
 
 HttpRequest::HttpMethod HttpRequest::method() const {
@@ -17,13 +27,14 @@ void HttpRequest::setMethod(HttpMethod method) {
     method_ = method;
 }
 
-void HttpRequest::setMethod(const std::string & methodStr) {
-    auto it = methodMap_.find(methodStr);
-    setMethod(it == methodMap_.cend() ? HttpMethod::kInvalid : it->second);
-}
-
-void HttpRequest::setMethod(const char * begin, const char * end) {
-    return setMethod(std::string(begin, end));
+void HttpRequest::setMethod(boost::string_view method) {
+    if(method == "GET") {
+        setMethod(HttpMethod::kGet);
+    } else if(method == "POST") {
+        setMethod(HttpMethod::kPost);
+    } else {
+        setMethod(HttpMethod::kInvalid);
+    }
 }
 
 HttpRequest::HttpVersion HttpRequest::version() const {
@@ -34,105 +45,202 @@ void HttpRequest::setVersion(HttpVersion version) {
     version_ = version;
 }
 
-void HttpRequest::setVersion(const std::string & versionStr) {
-    auto it = versionMap_.find(versionStr);
-    setVersion(it == versionMap_.cend() ? HttpVersion::kUnknown : it->second);
-}
-
-void HttpRequest::setVersion(const char * begin, const char * end) {
-    return setVersion(std::string(begin, end));
+void HttpRequest::setVersion(boost::string_view version) {
+    if(version == "HTTP/1.1") {
+        setVersion(HttpVersion::kHttp11);
+    } else if(version == "HTTP/1.0") {
+        setVersion(HttpVersion::kHttp10);
+    } else {
+        setVersion(HttpVersion::kUnknown);
+    }
 }
 
-const std::string & HttpRequest::path() const {
+boost::string_view HttpRequest::path() const {
     return path_;
 }
 
-void HttpRequest::setPath(const std::string & path) {
+void HttpRequest::setPath(boost::string_view path) {
     path_ = path;
 }
 
-void HttpRequest::setPath(const char * begin, const char * end) {
-    setPath(std::string(begin, end));
-}
-
-const std::string & HttpRequest::query() const {
+boost::string_view HttpRequest::query() const {
     assert(method_ == HttpMethod::kGet);
     return query_;
 }
 
-void HttpRequest::setQuery(const std::string & query) {
+void HttpRequest::setQuery(boost::string_view query) {
     assert(method_ == HttpMethod::kGet);
     query_ = query;
 }
 
-void HttpRequest::setQuery(const char * begin, const char * end) {
-    assert(method_ == HttpMethod::kGet);
-    setQuery(std::string(begin, end));
-}
-
-const std::string & HttpRequest::body() const {
-    assert(method_ == HttpMethod::kPost);
-    return query_;
-}
-
-void HttpRequest::setBody(const std::string & body) {
-    assert(method_ == HttpMethod::kPost);
-    query_ = body;
-}
-
-void HttpRequest::setBody(const char * begin, const char * end) {
+boost::string_view HttpRequest::body() const {
     assert(method_ == HttpMethod::kPost);
-    setBody(std::string(begin, end));
+    return body_;
 }
 
-void HttpRequest::appendBody(const std::string & body) {
+void HttpRequest::setBody(boost::string_view body) {
     assert(method_ == HttpMethod::kPost);
-    query_.append(body);
+    closeBodyFile();
+    ownedBody_.clear();
+    body_ = body;
+    bodySize_ = body.size();
 }
 
-void HttpRequest::appendBody(const char * begin, const char * end) {
+bool HttpRequest::appendBody(const char * begin, const char * end) {
     assert(method_ == HttpMethod::kPost);
-    appendBody(std::string(begin, end));
-}
-
-const std::string & HttpRequest::getHeader(const std::string & key) const {
-    auto it = headers_.find(key);
-    return it == headers_.cend() ? null : it->second;
-}
-
-void HttpRequest::setHeader(const std::string & key, const std::string & value) {
-    headers_[key] = value;
-}
-
-void HttpRequest::setHeader(const std::string & keyValueStr) {
-    size_t split = keyValueStr.find(": ");
-    assert(split != std::string::npos);
-
-    setHeader(keyValueStr.substr(0, split), keyValueStr.substr(split + 2));
-}
-
-void HttpRequest::setHeader(const char * begin, const char * end) {
-    setHeader(std::string(begin, end));
-}
-
-const std::unordered_map<std::string, std::string> & HttpRequest::headers() const {
+    if(bodyFile_ == -1 && body_.data() != ownedBody_.data()) {
+        // 之前引用的是外部内存，先拷贝过来
+        ownedBody_.assign(body_.data(), body_.size());
+    }
+    if(bodyFile_ == -1 && ownedBody_.size() + (end - begin) > kMaxBufferedBodySize && !spillBody()) {
+        return false;
+    }
+
+    if(bodyFile_ == -1) {
+        ownedBody_.append(begin, end);
+        body_ = ownedBody_;
+        bodySize_ += end - begin;
+        return true;
+    }
+
+    // 追加到临时文件的末尾
+    while(begin < end) {
+        ssize_t nBytes = ::write(bodyFile_, begin, end - begin);
+        if(nBytes == -1 && errno == EINTR) {
+            continue;
+        } else if(nBytes == -1) {
+            LOG(ERROR) << "Something wrong when call write() in HttpRequest::appendBody(), the errno is " << errno << "(" << strerror(errno) << ")";
+            return false;
+        }
+        begin += nBytes;
+        bodySize_ += nBytes;
+    }
+    return true;
+}
+
+size_t HttpRequest::bodySize() const {
+    return bodySize_;
+}
+
+int HttpRequest::bodyFile() const {
+    return bodyFile_;
+}
+
+boost::string_view HttpRequest::getHeader(boost::string_view key) const {
+    HttpHeader::Id id = HttpHeader::lookup(key);
+    if(id != HttpHeader::kUnknown) {
+        return getHeader(id);
+    }
+    for(const auto & header : headers_) {
+        if(header.id == HttpHeader::kUnknown && HttpHeader::equals(header.name, key)) {
+            return header.value;
+        }
+    }
+    return boost::string_view();
+}
+
+boost::string_view HttpRequest::getHeader(HttpHeader::Id id) const {
+    assert(id != HttpHeader::kUnknown);
+    for(const auto & header : headers_) {
+        if(header.id == id) {
+            return header.value;
+        }
+    }
+    return boost::string_view();
+}
+
+void HttpRequest::setHeader(boost::string_view key, boost::string_view value) {
+    setHeader(HttpHeader::lookup(key), key, value);
+}
+
+void HttpRequest::setHeader(HttpHeader::Id id, boost::string_view key, boost::string_view value) {
+    for(auto & header : headers_) {
+        if(id != HttpHeader::kUnknown ? header.id == id : header.id == HttpHeader::kUnknown && HttpHeader::equals(header.name, key)) {
+            header.value = value;
+            return ;
+        }
+    }
+    headers_.push_back(Header{id, key, value});
+}
+
+const HttpRequest::Headers & HttpRequest::headers() const {
     return headers_;
 }
 
-const std::string HttpRequest::null {};
-
-const std::unordered_map<std::string, HttpRequest::HttpMethod> HttpRequest::methodMap_ {
-    {"kGet", HttpMethod::kGet},
-    {"kPost", HttpMethod::kPost},
-
-    {"GET", HttpMethod::kGet},
-    {"POST", HttpMethod::kPost}
-};
-
-const std::unordered_map<std::string, HttpRequest::HttpVersion> HttpRequest::versionMap_ {
-    {"kHttp10", HttpVersion::kHttp10},
-    {"kHttp11", HttpVersion::kHttp11},
-
-    {"HTTP/1.0", HttpVersion::kHttp10},
-    {"HTTP/1.1", HttpVersion::kHttp11}
-};
+void HttpRequest::detach() {
+    if(detached_) {
+        return ;
+    }
+    detached_ = true;
+
+    // 预留全部容量，拷贝过程中storage_不会重新分配，之前拷贝的视图保持有效
+    size_t size = path_.size() + query_.size();
+    for(const auto & header : headers_) {
+        size += header.name.size() + header.value.size();
+    }
+    storage_.reserve(size);
+    copyToStorage(path_);
+    copyToStorage(query_);
+    for(auto & header : headers_) {
+        copyToStorage(header.name);
+        copyToStorage(header.value);
+    }
+    if(bodyFile_ == -1 && body_.data() != ownedBody_.data()) {
+        ownedBody_.assign(body_.data(), body_.size());
+        body_ = ownedBody_;
+    }
+}
+
+void HttpRequest::reset() {
+    closeBodyFile();
+    method_ = HttpMethod::kInvalid;
+    version_ = HttpVersion::kUnknown;
+    path_.clear();
+    query_.clear();
+    headers_.clear();
+    body_.clear();
+    bodySize_ = 0;
+    detached_ = false;
+
+    // 保留的容量过大时释放，避免空闲的长连接占用过多内存
+    ownedBody_.clear();
+    if(ownedBody_.capacity() > kMaxRetainedSize) {
+        std::string().swap(ownedBody_);
+    }
+    storage_.clear();
+    if(storage_.capacity() > kMaxRetainedSize) {
+        std::string().swap(storage_);
+    }
+}
+
+bool HttpRequest::spillBody() {
+    char path[] = "/tmp/tinyserver-body-XXXXXX";
+    int fd = ::mkostemp(path, O_CLOEXEC);
+    if(fd == -1) {
+        LOG(ERROR) << "Something wrong when call mkostemp() in HttpRequest::spillBody(), the errno is " << errno << "(" << strerror(errno) << ")";
+        return false;
+    }
+    // 立即删除文件名，文件在关闭后自动回收
+    ::unlink(path);
+    bodyFile_ = fd;
+
+    // 已缓存的部分先写入临时文件
+    std::string buffered;
+    buffered.swap(ownedBody_);
+    body_.clear();
+    bodySize_ = 0;
+    return appendBody(buffered.data(), buffered.data() + buffered.size());
+}
+
+void HttpRequest::closeBodyFile() {
+    if(bodyFile_ != -1) {
+        ::close(bodyFile_);
+        bodyFile_ = -1;
+    }
+}
+
+void HttpRequest::copyToStorage(boost::string_view & view) {
+    const char * data = storage_.data() + storage_.size();
+    storage_.append(view.data(), view.size());
+    view = boost::string_view(data, view.size());
+}
@@ -1,10 +1,17 @@
 #include "HttpResponse.h"
+#include "File.h"
 #include <algorithm>
 #include <cctype>
+#include <cassert>
 
 HttpResponse::HttpResponse()
     : version_(HttpVersion::kUnknown)
-    , statusCode_(HttpStatusCode::kInternalServerError) {
+    , statusCode_(HttpStatusCode::kInternalServerError)
+    , bodyData_(nullptr)
+    , bodySize_(0)
+    , fileOffset_(0)
+    , fileLength_(0)
+    , encodedHeaders_(nullptr) {
 }
 
 HttpResponse::~HttpResponse() {
@@ -36,19 +43,166 @@ const std::string & HttpResponse::body() const {
 
 void HttpResponse::setBody(const std::string & body) {
     body_ = body;
+    bodyHolder_.reset();
+    bodyData_ = nullptr;
+    bodySize_ = 0;
 }
 
-const std::string & HttpResponse::getHeader(const std::string & key) const {
-    auto it = headers_.find(key);
-    return it == headers_.cend() ? null : it->second;
+void HttpResponse::setBody(std::shared_ptr<const void> holder, const char * data, size_t size) {
+    body_.clear();
+    bodyHolder_ = holder;
+    bodyData_ = data;
+    bodySize_ = size;
 }
 
-void HttpResponse::setHeader(const std::string & key, const std::string & value) {
-    headers_[key] = value;
+std::shared_ptr<const void> HttpResponse::bodyHolder() const {
+    return bodyHolder_;
 }
 
-const std::unordered_map<std::string, std::string> & HttpResponse::headers() const {
+const char * HttpResponse::bodyData() const {
+    return bodyHolder_ ? bodyData_ : body_.data();
+}
+
+size_t HttpResponse::bodySize() const {
+    return bodyHolder_ ? bodySize_ : body_.size();
+}
+
+void HttpResponse::setFile(std::shared_ptr<File> file, off_t offset, size_t length) {
+    file_ = file;
+    fileOffset_ = offset;
+    fileLength_ = length;
+    body_.clear();
+    bodyHolder_.reset();
+    bodyData_ = nullptr;
+    bodySize_ = 0;
+}
+
+std::shared_ptr<File> HttpResponse::file() const {
+    return file_;
+}
+
+off_t HttpResponse::fileOffset() const {
+    return fileOffset_;
+}
+
+size_t HttpResponse::fileLength() const {
+    return fileLength_;
+}
+
+void HttpResponse::setBodyRanges(std::vector<BodyRange> ranges, const std::string & trailer) {
+    assert(file_ || bodyHolder_);
+    bodyRanges_ = std::move(ranges);
+    bodyTrailer_ = trailer;
+}
+
+const std::vector<HttpResponse::BodyRange> & HttpResponse::bodyRanges() const {
+    return bodyRanges_;
+}
+
+const std::string & HttpResponse::bodyTrailer() const {
+    return bodyTrailer_;
+}
+
+void HttpResponse::setChunkProvider(ChunkProvider provider) {
+    chunkProvider_ = std::move(provider);
+    file_.reset();
+    body_.clear();
+    bodyHolder_.reset();
+    bodyData_ = nullptr;
+    bodySize_ = 0;
+}
+
+const HttpResponse::ChunkProvider & HttpResponse::chunkProvider() const {
+    return chunkProvider_;
+}
+
+const std::string & HttpResponse::getHeader(boost::string_view key) const {
+    HttpHeader::Id id = HttpHeader::lookup(key);
+    if(id != HttpHeader::kUnknown) {
+        return getHeader(id);
+    }
+    for(const auto & header : headers_) {
+        if(header.id == HttpHeader::kUnknown && HttpHeader::equals(header.name, key)) {
+            return header.value;
+        }
+    }
+    return null;
+}
+
+const std::string & HttpResponse::getHeader(HttpHeader::Id id) const {
+    assert(id != HttpHeader::kUnknown);
+    for(const auto & header : headers_) {
+        if(header.id == id) {
+            return header.value;
+        }
+    }
+    return null;
+}
+
+void HttpResponse::setHeader(boost::string_view key, boost::string_view value) {
+    HttpHeader::Id id = HttpHeader::lookup(key);
+    if(id != HttpHeader::kUnknown) {
+        setHeader(id, value);
+        return ;
+    }
+    for(auto & header : headers_) {
+        if(header.id == HttpHeader::kUnknown && HttpHeader::equals(header.name, key)) {
+            header.value.assign(value.data(), value.size());
+            return ;
+        }
+    }
+    headers_.push_back(Header{id, key.to_string(), value.to_string()});
+}
+
+void HttpResponse::setHeader(HttpHeader::Id id, boost::string_view value) {
+    assert(id != HttpHeader::kUnknown);
+    for(auto & header : headers_) {
+        if(header.id == id) {
+            header.value.assign(value.data(), value.size());
+            return ;
+        }
+    }
+    // 常用首部使用规范的名称
+    headers_.push_back(Header{id, HttpHeader::name(id), value.to_string()});
+}
+
+void HttpResponse::setContentLength(size_t length) {
+    char buf[HttpContext::kMaxIntegerSize];
+    setHeader(HttpHeader::kContentLength, boost::string_view(buf, HttpContext::formatInteger(length, buf)));
+}
+
+const HttpResponse::Headers & HttpResponse::headers() const {
     return headers_;
 }
 
+void HttpResponse::setEncodedHeaders(std::shared_ptr<const void> holder, const std::string * encodedHeaders) {
+    encodedHeadersHolder_ = holder;
+    encodedHeaders_ = encodedHeaders;
+}
+
+const std::string * HttpResponse::encodedHeaders() const {
+    return encodedHeaders_;
+}
+
+void HttpResponse::reset() {
+    version_ = HttpVersion::kUnknown;
+    statusCode_ = HttpStatusCode::kInternalServerError;
+    body_.clear();
+    if(body_.capacity() > kMaxRetainedSize) {
+        std::string().swap(body_);
+    }
+    bodyHolder_.reset();
+    bodyData_ = nullptr;
+    bodySize_ = 0;
+    file_.reset();
+    fileOffset_ = 0;
+    fileLength_ = 0;
+    bodyRanges_.clear();
+    bodyTrailer_.clear();
+    chunkProvider_ = nullptr;
+    headers_.clear();
+    encodedHeadersHolder_.reset();
+    encodedHeaders_ = nullptr;
+}
+
 const std::string HttpResponse::null {};
@@ -12,8 +12,11 @@ HttpServer::HttpServer(EventLoop * loop, const std::string & name, const InetAdd
     , name_(name)
     , localAddr_(localAddr)
     , root_(root)
+    , service_(new HttpService(root_))
     , started_(false)
-    , service_(new HttpService(root_)) {
+    , idleTimeout_(0.0)
+    , edgeTriggered_(false)
+    , reusePort_(false) {
 }
 
 HttpServer::~HttpServer() {
@@ -31,6 +34,41 @@ const InetAddress & HttpServer::localAddress() const {
     return localAddr_;
 }
 
+void HttpServer::setIdleTimeout(double seconds) {
+    assert(!started_);
+    idleTimeout_ = seconds;
+}
+
+void HttpServer::setEdgeTriggered(bool enabled) {
+    assert(!started_);
+    edgeTriggered_ = enabled;
+}
+
+void HttpServer::setReusePort(bool enabled) {
+    assert(!started_);
+    reusePort_ = enabled;
+}
+
+void HttpServer::setFileCacheSize(size_t capacity) {
+    assert(!started_);
+    service_->setFileCacheSize(capacity);
+}
+
+void HttpServer::setMmapCacheSize(size_t capacity) {
+    assert(!started_);
+    service_->setMmapCacheSize(capacity);
+}
+
+void HttpServer::setGzipCacheSize(size_t capacity) {
+    assert(!started_);
+    service_->setGzipCacheSize(capacity);
+}
+
+void HttpServer::setServerName(const std::string & name) {
+    assert(!started_);
+    HttpContext::setServerName(name);
+}
+
 void HttpServer::start(int numThreads) {
     loop_->assertInLoopThread();
     assert(!started_);
@@ -39,8 +77,13 @@ void HttpServer::start(int numThreads) {
     started_ = true;
     tcpServer_.reset(new TcpServer(loop_, localAddr_, name_));
     tcpServer_->setThreadNum(numThreads);
+    tcpServer_->setIdleTimeout(idleTimeout_);
+    tcpServer_->setEdgeTriggered(edgeTriggered_);
+    tcpServer_->setReusePort(reusePort_);
+    tcpServer_->setThreadInitCallback(std::bind(&HttpServer::handleThreadInit, this, std::placeholders::_1));
     tcpServer_->setConnectionCallback(std::bind(&HttpServer::handleConnection, this, std::placeholders::_1));
     tcpServer_->setMessageCallback(std::bind(&HttpServer::handleMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+    tcpServer_->setWriteCompleteCallback(std::bind(&HttpServer::handleWriteComplete, this, std::placeholders::_1));
     tcpServer_->start();
 }
 
@@ -52,6 +95,10 @@ void HttpServer::stop() {
     tcpServer_.release();
 }
 
+void HttpServer::handleThreadInit(EventLoop * loop) {
+    HttpContext::startDateCache(loop);
+}
+
 void HttpServer::handleConnection(TcpConnectionPtr conn) {
     if(conn->connected()) {
         HttpContextPtr context = new HttpContext(conn);
@@ -67,3 +114,12 @@ void HttpServer::handleMessage(TcpConnectionPtr conn, BufferPtr message, TimeSta
     HttpContextPtr context = *boost::any_cast<HttpContextPtr>(&conn->getContext());
     context->process(message, receiveTime);
 }
+
+void HttpServer::handleWriteComplete(TcpConnectionPtr conn) {
+    // 写完成回调可能在连接断开（HttpContext已被释放）之后才被调用
+    if(!conn->connected()) {
+        return ;
+    }
+    HttpContextPtr context = *boost::any_cast<HttpContextPtr>(&conn->getContext());
+    context->handleWriteComplete();
+}
@@ -1,6 +1,9 @@
 #include "HttpService.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "File.h"
+#include "FileCache.h"
+#include "Gzip.h"
 #include <glog/logging.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -9,9 +12,18 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <vector>
+#include <cctype>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include "TimeStamp.h"
 
 HttpService::HttpService(const std::string & root)
-    : root_(root) {
+    : root_(root)
+    , fileCache_(nullptr)
+    , mmapCache_(nullptr)
+    , gzipCache_(nullptr) {
 }
 
 HttpService::~HttpService() {
@@ -29,59 +41,67 @@ void HttpService::service(HttpRequestPtr request, HttpResponsePtr response) {
     }
 }
 
+void HttpService::setFileCacheSize(size_t capacity) {
+    fileCache_.reset(capacity > 0 ? new FileCache(capacity, FileCache::kRead, 0, kMaxReadFileSize) : nullptr);
+}
+
+void HttpService::setMmapCacheSize(size_t capacity) {
+    // 只映射不适合读入堆内存的文件
+    mmapCache_.reset(capacity > 0 ? new FileCache(capacity, FileCache::kMmap, kMaxReadFileSize + 1, kMaxMmapFileSize) : nullptr);
+}
+
+void HttpService::setGzipCacheSize(size_t capacity) {
+    // 太小的文件压缩收益有限，更大的文件只使用预压缩文件
+    gzipCache_.reset(capacity > 0 ? new FileCache(capacity, FileCache::kGzip, Gzip::kMinCompressSize, kMaxReadFileSize) : nullptr);
+}
+
 void HttpService::doGet(HttpRequestPtr request, HttpResponsePtr response) {
     HttpResponsePtr resp;
     if(request->path() == "/test") {
         resp = HttpContext::generalResponse(HttpStatusCode::kOk);
     } else {
         // 计算文件地址
-        std::string realPath((root_.back() == '/' ? root_.substr(0, root_.size() - 1) : root_) + request->path());
-        DLOG(INFO) << "Real Path: " << realpath;
-        int fd = ::open(realPath.c_str(), O_RDONLY);
-        if(fd == -1) {
-            if(errno == EACCES) {
+        std::string realPath(getRealPath(request));
+        DLOG(INFO) << "Real Path: " << realPath;
+        if(serveCachedFile(request, response, realPath)) {
+            return ;
+        }
+
+        std::shared_ptr<File> file(std::make_shared<File>(realPath));
+        if(!file->valid()) {
+            if(file->error() == EACCES) {
                 resp = HttpContext::generalResponse(HttpStatusCode::kForbidden);
-            } else if(errno == ENOENT) {
+            } else if(file->error() == ENOENT) {
                 resp = HttpContext::generalResponse(HttpStatusCode::kNotFound);
             } else {
                 resp = HttpContext::generalResponse(HttpStatusCode::kInternalServerError);
             }
+        } else if(!file->isRegular()) {
+            resp = HttpContext::generalResponse(HttpStatusCode::kForbidden);
+        } else if(file->isExecutable()) {
+            resp = executeCgi(request);
         } else {
-            struct stat st;
-            bzero(&st, sizeof(st));
-            stat(realPath.c_str(), &st);
-            std::vector<char> msg;
-            msg.resize(st.st_size);
-
-            if(st.st_mode & S_IXUSR) {
-                resp = executeCgi(request);
-            } else {
-                ssize_t nBytes = ::read(fd, msg.data(), msg.size());
-                if(nBytes == -1) {
-                    resp = HttpContext::generalResponse(HttpStatusCode::kInternalServerError);
-                } else {
-                    resp = HttpContext::simpleResponse(request->version(), HttpStatusCode::kOk, request->path(), std::string(msg.data(), nBytes));
-                }
-            }
+            // 静态文件
+            serveFile(request, response, file);
+            return ;
         }
     }
 
     // FIXME 性能优化
     response->setVersion(resp->version());
     response->setStatusCode(resp->statusCode());
-    for(const auto & kv : resp->headers()) {
-        response->setHeader(kv.first, kv.second);
+    for(const auto & header : resp->headers()) {
+        response->setHeader(header.name, header.value);
     }
     response->setBody(resp->body());
 
-    const std::string & connectionHeader = request->getHeader("Connection");
-    response->setHeader("Connection", connectionHeader.empty() ? (request->version() == HttpVersion::kHttp11 ? "keep-alive" : "close") : connectionHeader);
+    setConnectionHeader(request, response);
 }
 
 void HttpService::doPost(HttpRequestPtr request, HttpResponsePtr response) {// 计算文件地址
     HttpResponsePtr resp;
     
-    std::string realPath((root_.back() == '/' ? root_.substr(0, root_.size() - 1) : root_) + request->path());
+    std::string realPath(getRealPath(request));
     struct stat st;
     bzero(&st, sizeof(st));
     if(stat(realPath.c_str(), &st) == -1) {
@@ -95,17 +115,366 @@ void HttpService::doPost(HttpRequestPtr request, HttpResponsePtr response) {// 
     // FIXME 性能优化
     response->setVersion(resp->version());
     response->setStatusCode(resp->statusCode());
-    for(const auto & kv : resp->headers()) {
-        response->setHeader(kv.first, kv.second);
+    for(const auto & header : resp->headers()) {
+        response->setHeader(header.name, header.value);
     }
     response->setBody(resp->body());
 
-    const std::string & connectionHeader = request->getHeader("Connection");
-    response->setHeader("Connection", connectionHeader.empty() ? (request->version() == HttpVersion::kHttp11 ? "keep-alive" : "close") : connectionHeader);
+    setConnectionHeader(request, response);
+}
+
+void HttpService::serveFile(HttpRequestPtr request, HttpResponsePtr response, std::shared_ptr<File> file) {
+    response->setVersion(request->version());
+    const std::string & contentType = getContentType(file->path());
+    time_t modifyTime = file->modifyTime();
+    std::string lastModified(HttpContext::formatHttpDate(modifyTime));
+    std::string etag;
+    std::shared_ptr<File> precompressed(acceptGzip(request, contentType) ? openPrecompressed(*file) : nullptr);
+    if(precompressed) {
+        // 发送预先压缩好的文件，Content-Type和Last-Modified仍取自原文件
+        etag = generateETag(file->size(), file->status().st_mtim, "gzip");
+        file = precompressed;
+        response->setHeader("Content-Encoding", "gzip");
+    } else {
+        etag = generateETag(file->size(), file->status().st_mtim);
+    }
+    if(Gzip::compressible(contentType)) {
+        response->setHeader("Vary", "Accept-Encoding");
+    }
+    // 文件内容不经过用户空间，由sendfile()直接从文件发送到socket
+    response->setFile(file, 0, file->size());
+
+    std::vector<ByteRange> ranges;
+    if(isNotModified(request, etag, modifyTime)) {
+        setNotModifiedResponse(response, etag, lastModified);
+    } else if(parseRange(request, file->size(), etag, lastModified, ranges)) {
+        setRangeResponse(response, ranges, file->size(), contentType, etag, lastModified);
+    } else {
+        response->setStatusCode(HttpStatusCode::kOk);
+        response->setHeader("Content-Type", contentType);
+        response->setContentLength(file->size());
+        response->setHeader("Last-Modified", lastModified);
+        response->setHeader("ETag", etag);
+        response->setHeader("Accept-Ranges", "bytes");
+    }
+
+    setConnectionHeader(request, response);
+}
+
+bool HttpService::serveCachedFile(HttpRequestPtr request, HttpResponsePtr response, const std::string & realPath) {
+    if(!fileCache_ && !mmapCache_ && !gzipCache_) {
+        return false;
+    }
+    struct stat st;
+    if(::stat(realPath.c_str(), &st) == -1) {
+        return false;
+    }
+
+    // 客户端接受gzip时优先使用gzip缓存，否则根据文件大小选择缓存
+    FileCache::EntryPtr entry;
+    bool gzipEntry = false;
+    if(acceptGzip(request, getContentType(realPath))) {
+        if(gzipCache_ && gzipCache_->acceptable(st)) {
+            entry = gzipCache_->get(realPath, st);
+            gzipEntry = static_cast<bool>(entry);
+        } else if(openPrecompressed(realPath, st)) {
+            // 超出gzip缓存范围但有预压缩文件，由serveFile()发送
+            return false;
+        }
+    }
+    if(!entry) {
+        if(fileCache_ && fileCache_->acceptable(st)) {
+            entry = fileCache_->get(realPath, st);
+        } else if(mmapCache_ && mmapCache_->acceptable(st)) {
+            entry = mmapCache_->get(realPath, st);
+        }
+    }
+    if(!entry) {
+        return false;
+    }
+
+    response->setVersion(request->version());
+    // 响应体直接引用缓存的内容（堆内存或映射区域），发送时不拷贝
+    response->setBody(entry, entry->data, entry->size);
+
+    std::vector<ByteRange> ranges;
+    if(isNotModified(request, entry->etag, entry->modifyTime.tv_sec)) {
+        setNotModifiedResponse(response, entry->etag, entry->lastModified);
+    } else if(parseRange(request, entry->size, entry->etag, entry->lastModified, ranges)) {
+        setRangeResponse(response, ranges, entry->size, entry->contentType, entry->etag, entry->lastModified);
+    } else {
+        response->setStatusCode(HttpStatusCode::kOk);
+        // 完整响应的首部已经预先编码在entry中
+        response->setEncodedHeaders(entry, &entry->headers);
+    }
+    if(response->statusCode() != HttpStatusCode::kOk) {
+        // 304和206不使用预先编码的首部，须与serveFile()一样补上内容编码相关的首部，否则区间会被当作原文件的内容
+        if(gzipEntry) {
+            response->setHeader(HttpHeader::kContentEncoding, "gzip");
+        }
+        if(Gzip::compressible(entry->contentType)) {
+            response->setHeader(HttpHeader::kVary, "Accept-Encoding");
+        }
+    }
+
+    setConnectionHeader(request, response);
+    return true;
+}
+
+bool HttpService::acceptGzip(HttpRequestPtr request, const std::string & contentType) {
+    return Gzip::compressible(contentType) && Gzip::accepted(request->getHeader(HttpHeader::kAcceptEncoding));
+}
+
+std::shared_ptr<File> HttpService::openPrecompressed(const File & file) {
+    return openPrecompressed(file.path(), file.status());
+}
+
+std::shared_ptr<File> HttpService::openPrecompressed(const std::string & path, const struct stat & st) {
+    std::shared_ptr<File> precompressed(std::make_shared<File>(path + ".gz"));
+    if(!precompressed->valid() || !precompressed->isRegular()) {
+        return nullptr;
+    }
+    // 早于原文件的预压缩文件可能已经过期
+    const struct timespec & original = st.st_mtim;
+    const struct timespec & compressed = precompressed->status().st_mtim;
+    if(compressed.tv_sec < original.tv_sec || (compressed.tv_sec == original.tv_sec && compressed.tv_nsec < original.tv_nsec)) {
+        return nullptr;
+    }
+    return precompressed;
+}
+
+bool HttpService::isNotModified(HttpRequestPtr request, const std::string & etag, time_t modifyTime) {
+    // If-None-Match优先于If-Modified-Since
+    boost::string_view ifNoneMatch = request->getHeader(HttpHeader::kIfNoneMatch);
+    if(!ifNoneMatch.empty()) {
+        return matchETag(ifNoneMatch, etag, true);
+    }
+
+    boost::string_view ifModifiedSince = request->getHeader(HttpHeader::kIfModifiedSince);
+    time_t since = 0;
+    if(!ifModifiedSince.empty() && HttpContext::parseHttpDate(ifModifiedSince.to_string(), &since)) {
+        return modifyTime <= since;
+    }
+    return false;
+}
+
+bool HttpService::matchETag(boost::string_view header, const std::string & etag, bool weak) {
+    if(header == "*") {
+        return true;
+    }
+
+    // header是以逗号分隔的ETag列表
+    boost::string_view::size_type pos = 0;
+    while(pos < header.size()) {
+        boost::string_view::size_type begin = header.find_first_not_of(" \t,", pos);
+        if(begin == boost::string_view::npos) {
+            break;
+        }
+        boost::string_view::size_type end = header.find(',', begin);
+        if(end == boost::string_view::npos) {
+            end = header.size();
+        }
+        boost::string_view::size_type last = header.find_last_not_of(" \t", end - 1);
+        boost::string_view candidate(header.substr(begin, last - begin + 1));
+
+        // 弱比较忽略W/前缀，强比较要求双方都不是弱ETag（etag总是强ETag）
+        if(candidate.starts_with("W/")) {
+            if(weak && candidate.substr(2) == etag) {
+                return true;
+            }
+        } else if(candidate == etag) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+void HttpService::setNotModifiedResponse(HttpResponsePtr response, const std::string & etag, const std::string & lastModified) {
+    // 304没有响应体
+    response->setStatusCode(HttpStatusCode::kNotModified);
+    response->setHeader("ETag", etag);
+    response->setHeader("Last-Modified", lastModified);
+    response->setFile(nullptr, 0, 0);
+}
+
+bool HttpService::parseRange(HttpRequestPtr request, off_t size, const std::string & etag, const std::string & lastModified, std::vector<ByteRange> & ranges) {
+    const std::string range(request->getHeader(HttpHeader::kRange).to_string());
+    if(range.empty()) {
+        return false;
+    }
+    // If-Range与当前的ETag（强比较）或Last-Modified不一致说明客户端持有的是旧版本，须返回完整内容
+    boost::string_view ifRange = request->getHeader(HttpHeader::kIfRange);
+    if(!ifRange.empty()) {
+        bool isETag = ifRange[0] == '"' || ifRange.starts_with("W/");
+        if(isETag ? !matchETag(ifRange, etag, false) : ifRange != lastModified) {
+            return false;
+        }
+    }
+
+    static const std::string unit("bytes=");
+    if(range.compare(0, unit.size(), unit) != 0) {
+        // 不支持的单位，忽略Range
+        return false;
+    }
+
+    ranges.clear();
+    std::string::size_type pos = unit.size();
+    while(pos <= range.size()) {
+        std::string::size_type comma = range.find(',', pos);
+        if(comma == std::string::npos) {
+            comma = range.size();
+        }
+        // 去掉首尾空白
+        std::string::size_type begin = range.find_first_not_of(" \t", pos);
+        std::string::size_type end = range.find_last_not_of(" \t", comma - 1);
+        if(begin == std::string::npos || begin >= comma || end < begin) {
+            return false;
+        }
+        std::string spec(range, begin, end - begin + 1);
+        std::string::size_type dash = spec.find('-');
+        if(dash == std::string::npos || spec.find_first_not_of("0123456789-") != std::string::npos || spec.find('-', dash + 1) != std::string::npos) {
+            return false;
+        }
+
+        std::string first(spec, 0, dash);
+        std::string last(spec, dash + 1);
+        if(first.empty() && last.empty()) {
+            return false;
+        }
+        if(first.size() > kMaxRangeDigits || last.size() > kMaxRangeDigits) {
+            return false;
+        }
+
+        ByteRange byteRange;
+        if(first.empty()) {
+            // 后缀区间：最后last个字节
+            off_t suffix = std::stoll(last);
+            if(suffix > 0 && size > 0) {
+                byteRange.first = suffix >= size ? 0 : size - suffix;
+                byteRange.second = size - 1;
+                ranges.push_back(byteRange);
+            }
+        } else {
+            byteRange.first = std::stoll(first);
+            byteRange.second = last.empty() ? size - 1 : std::stoll(last);
+            if(!last.empty() && byteRange.second < byteRange.first) {
+                // 语法错误，忽略Range
+                return false;
+            }
+            if(byteRange.first < size) {
+                // 起点超出文件大小的区间不可满足，跳过
+                if(byteRange.second >= size) {
+                    byteRange.second = size - 1;
+                }
+                ranges.push_back(byteRange);
+            }
+        }
+        if(ranges.size() > kMaxRanges) {
+            // 区间过多，可能是恶意请求，忽略Range返回完整内容
+            return false;
+        }
+
+        pos = comma + 1;
+    }
+
+    return true;
+}
+
+void HttpService::setRangeResponse(HttpResponsePtr response, const std::vector<ByteRange> & ranges, off_t size, const std::string & contentType, const std::string & etag, const std::string & lastModified) {
+    if(ranges.empty()) {
+        // 所有区间都不可满足
+        response->setStatusCode(HttpStatusCode::kRangeNotSatisfiable);
+        response->setHeader("Content-Range", "bytes */" + std::to_string(size));
+        response->setContentLength(0);
+        response->setFile(nullptr, 0, 0);
+        return ;
+    }
+
+    response->setStatusCode(HttpStatusCode::kPartialContent);
+    response->setHeader("Last-Modified", lastModified);
+    response->setHeader("ETag", etag);
+    response->setHeader("Accept-Ranges", "bytes");
+    std::string total("/" + std::to_string(size));
+    if(ranges.size() == 1) {
+        // 单个区间：响应体只包含该区间
+        off_t offset = ranges.front().first;
+        size_t length = ranges.front().second - ranges.front().first + 1;
+        response->setHeader("Content-Type", contentType);
+        response->setHeader("Content-Range", "bytes " + std::to_string(ranges.front().first) + "-" + std::to_string(ranges.front().second) + total);
+        response->setContentLength(length);
+        if(response->file()) {
+            response->setFile(response->file(), offset, length);
+        } else {
+            response->setBody(response->bodyHolder(), response->bodyData() + offset, length);
+        }
+        return ;
+    }
+
+    // 多个区间：multipart/byteranges
+    std::string boundary(generateBoundary());
+    std::vector<HttpResponse::BodyRange> bodyRanges;
+    size_t contentLength = 0;
+    for(const auto & range : ranges) {
+        HttpResponse::BodyRange bodyRange;
+        bodyRange.header = "\r\n--" + boundary + "\r\n"
+                         + "Content-Type: " + contentType + "\r\n"
+                         + "Content-Range: bytes " + std::to_string(range.first) + "-" + std::to_string(range.second) + total + "\r\n\r\n";
+        bodyRange.offset = range.first;
+        bodyRange.length = range.second - range.first + 1;
+        contentLength += bodyRange.header.size() + bodyRange.length;
+        bodyRanges.push_back(std::move(bodyRange));
+    }
+    std::string trailer("\r\n--" + boundary + "--\r\n");
+    contentLength += trailer.size();
+
+    response->setHeader("Content-Type", "multipart/byteranges; boundary=" + boundary);
+    response->setContentLength(contentLength);
+    response->setBodyRanges(std::move(bodyRanges), trailer);
+}
+
+std::string HttpService::generateETag(off_t size, const struct timespec & modifyTime, const std::string & encoding) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "\"%llx.%lx-%llx", static_cast<unsigned long long>(modifyTime.tv_sec), static_cast<unsigned long>(modifyTime.tv_nsec), static_cast<unsigned long long>(size));
+    return encoding.empty() ? std::string(buf) + "\"" : std::string(buf) + "-" + encoding + "\"";
+}
+
+std::string HttpService::generateBoundary() {
+    static std::atomic<uint64_t> sequence(0);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(TimeStamp::now().microseconds() ^ (++sequence << 40)));
+    return std::string("tinyserver-") + buf;
+}
+
+std::string HttpService::getRealPath(HttpRequestPtr request) const {
+    // 请求路径直接从视图追加，不构造中间字符串
+    std::string realPath(root_.data(), root_.back() == '/' ? root_.size() - 1 : root_.size());
+    realPath.append(request->path().data(), request->path().size());
+    return realPath;
+}
+
+void HttpService::setConnectionHeader(HttpRequestPtr request, HttpResponsePtr response) {
+    boost::string_view connectionHeader = request->getHeader(HttpHeader::kConnection);
+    response->setHeader("Connection", connectionHeader.empty() ? (request->version() == HttpVersion::kHttp11 ? "keep-alive" : "close") : connectionHeader.to_string());
+}
+
+const std::string & HttpService::getContentType(const std::string & path) {
+    std::string::size_type dot = path.rfind('.');
+    if(dot != std::string::npos && path.find('/', dot) == std::string::npos) {
+        std::string extension(path.substr(dot + 1));
+        for(char & c : extension) {
+            c = ::tolower(c);
+        }
+        auto it = contentTypes_.find(extension);
+        if(it != contentTypes_.cend()) {
+            return it->second;
+        }
+    }
+    return defaultContentType_;
 }
 
 HttpService::HttpResponsePtr HttpService::executeCgi(HttpRequestPtr request) {
-    std::string realPath((root_.back() == '/' ? root_.substr(0, root_.size() - 1) : root_) + request->path());
+    std::string realPath(getRealPath(request));
     int cgiInput[2] = {};
     int cgiOutput[2] = {};
     pipe(cgiInput);
@@ -130,11 +499,11 @@ HttpService::HttpResponsePtr HttpService::executeCgi(HttpRequestPtr request) {
 
         if(request->method() == HttpMethod::kGet) {
             char queryEnv[512];
-            sprintf(queryEnv, "QUERY_STRING=%s", request->query().c_str());
+            snprintf(queryEnv, sizeof(queryEnv), "QUERY_STRING=%.*s", static_cast<int>(request->query().size()), request->query().data());
             putenv(queryEnv);
         } else if(request->method() == HttpMethod::kPost) {
             char contentLengthEnv[128];
-            sprintf(contentLengthEnv, "CONTENT_LENGTH=%s", request->getHeader("Content-Length").c_str());
+            sprintf(contentLengthEnv, "CONTENT_LENGTH=%zu", request->bodySize());
             putenv(contentLengthEnv);
         }
 
@@ -146,7 +515,7 @@ HttpService::HttpResponsePtr HttpService::executeCgi(HttpRequestPtr request) {
         close(cgiInput[0]);
 
         if(request->method() == HttpMethod::kPost) {
-            write(cgiInput[1], request->body().c_str(), request->body().size());
+            writeRequestBody(request, cgiInput[1]);
         }
 
         char buf[1024] = {0};
@@ -165,8 +534,52 @@ HttpService::HttpResponsePtr HttpService::executeCgi(HttpRequestPtr request) {
         close(cgiInput[1]);
         close(cgiOutput[0]);
         wait(nullptr);
-        return HttpContext::simpleResponse(HttpVersion::kHttp11, HttpStatusCode::kOk, request->path(), msg);
+        return HttpContext::simpleResponse(HttpVersion::kHttp11, HttpStatusCode::kOk, request->path().to_string(), msg);
     }
 
     return HttpContext::generalResponse(HttpStatusCode::kInternalServerError);
 }
+
+void HttpService::writeRequestBody(HttpRequestPtr request, int fd) {
+    if(request->bodyFile() == -1) {
+        write(fd, request->body().data(), request->body().size());
+        return ;
+    }
+
+    // 请求体已转存到临时文件中，分段读出后写入
+    char buf[65536];
+    off_t offset = 0;
+    while(offset < static_cast<off_t>(request->bodySize())) {
+        ssize_t nBytes = pread(request->bodyFile(), buf, sizeof(buf), offset);
+        if(nBytes <= 0 || write(fd, buf, nBytes) != nBytes) {
+            LOG(ERROR) << "Failed to pass request body to CGI, the errno is " << errno << "(" << strerror(errno) << ")";
+            return ;
+        }
+        offset += nBytes;
+    }
+}
+
+const std::unordered_map<std::string, std::string> HttpService::contentTypes_ {
+    {"html",    "text/html;charset=utf-8"       },
+    {"htm",     "text/html;charset=utf-8"       },
+    {"css",     "text/css;charset=utf-8"        },
+    {"js",      "application/javascript"        },
+    {"json",    "application/json"              },
+    {"xml",     "application/xml"               },
+    {"txt",     "text/plain;charset=utf-8"      },
+    {"png",     "image/png"                     },
+    {"jpg",     "image/jpeg"                    },
+    {"jpeg",    "image/jpeg"                    },
+    {"gif",     "image/gif"                     },
+    {"svg",     "image/svg+xml"                 },
+    {"ico",     "image/x-icon"                  },
+    {"webp",    "image/webp"                    },
+    {"pdf",     "application/pdf"               },
+    {"wasm",    "application/wasm"              },
+    {"woff",    "font/woff"                     },
+    {"woff2",   "font/woff2"                    },
+    {"mp3",     "audio/mpeg"                    },
+    {"mp4",     "video/mp4"                     }
+};
+
+const std::string HttpService::defaultContentType_ {"application/octet-stream"};
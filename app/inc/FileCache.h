@@ -0,0 +1,99 @@
+#ifndef __FILECACHE_H__
+#define __FILECACHE_H__
+
+#include <boost/utility.hpp>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "Mutex.h"
+
+class File;
+
+// 静态文件的内存缓存，以文件的真实路径为键，缓存文件内容和预先编码好的响应首部
+// 分为多个分片，每个分片各自加锁并按LRU淘汰，多个IO线程并发访问时锁竞争较小
+// 每次访问都须提供文件当前的stat()结果，修改时间或大小变化时重新加载，保证不会返回过期的内容
+// 文件内容有两种加载方式：
+// 1. kRead：读入堆内存，适合小文件
+// 2. kMmap：只读映射到内存，映射由各IO线程的请求共享并引用计数，最后一个引用释放时解除映射，适合中等大小的文件
+//    注意：映射期间文件被截断会导致访问映射区域时收到SIGBUS，因此只应映射不会被原地截断的文件
+// 3. kGzip：缓存gzip编码后的内容，优先读入同目录下预先压缩好的path.gz（不早于原文件时），否则在加载时压缩原文件
+class FileCache: public boost::noncopyable {
+public:
+    enum LoadMode {
+        kRead,
+        kMmap,
+        kGzip
+    };
+
+    struct Entry {
+        std::string path;                   // 文件的真实路径
+        std::shared_ptr<const void> storage;    // 文件内容的持有者
+        const char * data;                  // 文件内容
+        size_t size;                        // 内容大小（kGzip为编码后的大小）
+        size_t fileSize;                    // 加载时原文件的大小
+        struct timespec modifyTime;         // 原文件的最后修改时间
+        std::string contentType;            // Content-Type
+        std::string lastModified;           // Last-Modified（HTTP日期）
+        std::string etag;                   // ETag（由文件大小和修改时间生成的强校验值）
+        std::string headers;                // 预先编码好的完整响应（200）的首部行（每行以CRLF结尾）
+        bool precompressed;                 // 内容是否来自预先压缩好的path.gz（仅kGzip）
+        struct stat gzipStatus;             // 加载时path.gz的stat()结果（仅precompressed为true时有效）
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    // capacity为所有分片的总字节数上限，只缓存大小在[minFileSize, maxFileSize]之间的文件（maxFileSize不超过分片的上限）
+    FileCache(size_t capacity, LoadMode mode = kRead, size_t minFileSize = 0, size_t maxFileSize = kDefaultMaxFileSize);
+    ~FileCache();
+
+    // 判断stat()结果为st的文件是否适合缓存（普通文件、不可执行、大小在范围内）
+    bool acceptable(const struct stat & st) const;
+    // 获取文件，st为调用者刚刚stat()得到的结果，未缓存或已过期时从磁盘加载
+    // 文件不适合缓存或加载失败时返回nullptr
+    EntryPtr get(const std::string & path, const struct stat & st);
+
+    // 缓存的总字节数
+    size_t bytes() const;
+    // 命中次数
+    uint64_t hits() const;
+    // 未命中次数
+    uint64_t misses() const;
+
+private:
+    struct Shard {
+        MutexLock mutex;
+        std::list<EntryPtr> lru;        // 表头为最近使用的条目
+        std::unordered_map<std::string, std::list<EntryPtr>::iterator> index;
+        size_t bytes;
+    };
+
+    // 将文件加载到内存中（记录的是打开后fstat()得到的版本）
+    EntryPtr load(const std::string & path);
+    // 将文件读入堆内存
+    bool readFile(const File & file, Entry & entry);
+    // 将文件映射到内存
+    bool mapFile(const File & file, Entry & entry);
+    // 加载gzip编码后的内容，优先使用预先压缩好的文件
+    bool loadGzip(const File & file, Entry & entry);
+    // 获取path所在的分片
+    Shard & shardOf(const std::string & path);
+    // 从分片中移除条目（须持有分片的锁）
+    void eraseLocked(Shard & shard, std::list<EntryPtr>::iterator it);
+
+    const LoadMode mode_;           // 加载方式
+    const size_t shardCapacity_;    // 每个分片的字节数上限
+    const size_t minFileSize_;      // 可以缓存的最小文件
+    const size_t maxFileSize_;      // 可以缓存的最大文件
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+
+    static constexpr int kNumShards = 16;
+    static constexpr size_t kDefaultMaxFileSize = 1024 * 1024;
+};
+
+#endif //__FILECACHE_H__
@@ -0,0 +1,22 @@
+#ifndef __GZIP_H__
+#define __GZIP_H__
+
+#include <boost/utility.hpp>
+#include <boost/utility/string_view.hpp>
+#include <string>
+
+// gzip内容编码相关的工具函数
+class Gzip: public boost::noncopyable {
+public:
+    // 使用zlib将data压缩为gzip格式，追加到output中，失败时返回false
+    static bool compress(const char * data, size_t size, std::string * output, int level = kDefaultLevel);
+    // 根据Accept-Encoding首部判断客户端是否接受gzip编码
+    static bool accepted(boost::string_view acceptEncoding);
+    // 判断Content-Type对应的内容是否值得压缩（文本类内容）
+    static bool compressible(const std::string & contentType);
+
+    static constexpr int kDefaultLevel = 6;             // 压缩级别
+    static constexpr size_t kMinCompressSize = 1024;    // 小于该长度的内容压缩收益太小，不压缩
+};
+
+#endif //__GZIP_H__
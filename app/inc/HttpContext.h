@@ -4,14 +4,18 @@
 #include <boost/utility.hpp>
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include <memory>
 #include <functional>
+#include <ctime>
+#include <cstdint>
 
 class Buffer;
 class HttpRequest;
 class HttpResponse;
 class TcpConnection;
 class TimeStamp;
+class EventLoop;
 
 class HttpContext: public boost::noncopyable {
 public:
@@ -35,10 +39,13 @@ public:
 
     enum HttpStatusCode {
         kOk                         = 200,
+        kPartialContent             = 206,
+        kNotModified                = 304,
         kBadRequest                 = 400,
         kForbidden                  = 403,
         kNotFound                   = 404,
         kMethodNotAllowed           = 405,
+        kRangeNotSatisfiable        = 416,
         kInternalServerError        = 500,
         kNotImplemented             = 501,
         kHttpVersionNotSupported    = 505
@@ -50,29 +57,84 @@ public:
     TcpConnectionPtr getTcpConnection() const;
 
     void process(BufferPtr message, TimeStamp received);
+    // 发送缓冲清空时调用（由HttpServer转发TcpConnection的写完成回调），继续发送分块传输的响应体
+    void handleWriteComplete();
     void setServiceCallback(ServiceCallback callback);
 
     static const std::string & getStatusMessage(HttpStatusCode statusCode);
     static const std::string & getVersionMessage(HttpVersion version);
     static const std::string & getMethodMessage(HttpMethod method);
+    // 预先格式化好的状态行（如"HTTP/1.1 200 OK\r\n"）
+    static const std::string & getStatusLine(HttpVersion version, HttpStatusCode statusCode);
     static HttpResponsePtr generalResponse(HttpStatusCode statusCode);
     static HttpResponsePtr simpleResponse(HttpVersion version, HttpStatusCode statusCode, const std::string & title, const std::string & content);
+    // 在loop所在的线程中缓存Date首部并每秒更新一次，编码响应时直接拷贝，须在loop所在的线程中调用
+    // 没有启动缓存的线程在编码每个响应时重新格式化
+    static void startDateCache(EventLoop * loop);
+    // 设置Server首部和错误页面中的服务器名称，须在处理请求之前调用
+    static void setServerName(const std::string & name);
+    static const std::string & serverName();
+    // 将时间格式化为HTTP日期（如Sun, 06 Nov 1994 08:49:37 GMT）
+    static std::string formatHttpDate(time_t time);
+    // 解析HTTP日期，格式错误时返回false
+    static bool parseHttpDate(const std::string & date, time_t * time);
+    // 将非负整数格式化为十进制写入buf（至少kMaxIntegerSize字节，不以'\0'结尾），返回写入的长度
+    static size_t formatInteger(uint64_t value, char * buf);
+    // 将状态行和首部（包括没有设置时追加的Date和Server）编码到message中：先计算总长度并一次预留空间，再依次拷贝
+    static void encodeHttpResponse(HttpResponsePtr response, BufferPtr message);
+
+    static constexpr size_t kMaxIntegerSize = 20;           // uint64_t的最大十进制位数
 
 private:
     enum HttpRequestDecodeState {
-        kDecodeRequestLine,
-        kDecodeRequestHeaders,
+        kDecodeRequestHead,             // 请求行和首部
         kDecodeRequestBody,
+        kDecodeRequestContent,          // Content-Length指定长度的请求体
+        kDecodeRequestChunkSize,        // chunked编码的分块长度行
+        kDecodeRequestChunkData,        // chunked编码的分块数据及其后的CRLF
+        kDecodeRequestChunkTrailer,     // chunked编码的trailer
         kDecodeRequestDone,
         kDecodeRequestError
     };
 
+    // 查找接收缓冲中的第一个CRLF，找不到时记录已扫描的长度，数据到达后从该位置继续查找
     const char * findCRLF(BufferPtr message);
-    const char * findSpace(BufferPtr message);
-    const char * findColon(BufferPtr message);
-    const char * findQuestionMark(BufferPtr message);
+    // 查找接收缓冲中请求头的结尾（空行之后），同样从上次停止的位置继续查找
+    const char * findHeadEnd(BufferPtr message);
+    // 解析完整的请求头[begin, end)，格式错误时返回false
+    bool parseRequestHead(HttpRequestPtr request, const char * begin, const char * end);
+    // 以下函数在[begin, end)（一行之内）中查找分隔符，找不到时返回nullptr
+    const char * findCRLF(const char * begin, const char * end);
+    const char * findSpace(const char * begin, const char * end);
+    const char * findColon(const char * begin, const char * end);
+    const char * findQuestionMark(const char * begin, const char * end);
     void decodeHttpRequest(HttpRequestPtr request, BufferPtr message);
-    void encodeHttpResponse(HttpResponsePtr response, BufferPtr message);
+    // 依次处理接收缓冲中所有完整的请求，并将合并后的响应一起发送
+    void processRequests();
+    // 解码并处理一个请求，请求不完整、出错或连接即将关闭时返回false
+    bool processRequest();
+    // 客户端接受gzip时压缩动态生成的文本响应体（静态文件由HttpService处理）
+    void compressHttpResponse(HttpRequestPtr request, HttpResponsePtr response);
+    // 编码response，状态行、首部和较小的响应体写入responseBuffer_，随后由flushResponseBuffer()发送
+    void sendHttpResponse(HttpResponsePtr response);
+    // 发送responseBuffer_中的数据
+    void flushResponseBuffer();
+    // 暂停读取（已接收的数据仍留在接收缓冲中）
+    void pauseReading();
+    // 恢复读取
+    void resumeReading();
+    // 从数据源获取并发送响应体的分块，直到发送缓冲中待发送的数据达到上限或响应体结束
+    void sendNextChunks();
+    // 响应体结束，发送最后一个分块
+    void finishStreaming();
+    // 重新格式化当前线程缓存的Date首部
+    static void updateDateHeader();
+    // 状态行在statusLines_中的下标
+    static size_t statusLineIndex(HttpVersion version, HttpStatusCode statusCode);
+    // 生成所有版本和状态码组合的状态行
+    static std::vector<std::string> makeStatusLines();
+    // 释放（或回收）request和response，并从接收缓冲中取走request引用的数据
+    void releaseRequest();
     void handleRequestError();
     void handleProcessError();
 
@@ -81,18 +143,41 @@ private:
 
     HttpRequestPtr request_;
     HttpResponsePtr response_;
+    HttpRequestPtr spareRequest_;           // 处理完毕、等待复用的request
+    HttpResponsePtr spareResponse_;         // 发送完毕、等待复用的response
 
     HttpRequestDecodeState requestDecodeState_;
     ssize_t requestBodyRemainingSize_;
-    const char * requestBodyEnd_;
+    size_t requestPinnedSize_;              // 当前请求在接收缓冲中被视图引用、尚未取走的数据长度
+    size_t crlfScanOffset_;                 // 接收缓冲中已经确认不含CRLF的前缀长度
 
+    BufferPtr inputBuffer_;                 // TcpConnection的接收缓冲
     std::unique_ptr<Buffer> responseBuffer_;
+    bool readingPaused_;                    // 是否暂停了读取
+
+    HttpResponsePtr streamingResponse_;     // 正在分块发送响应体的response
+    bool chunkedStreaming_;                 // 是否使用chunked编码（HTTP/1.0以关闭连接表示响应体结束）
+    bool closeAfterStreaming_;              // 响应体发送完毕后是否关闭连接
 
     static const std::unordered_map<HttpStatusCode, std::string> statusMessage_;
     static const std::unordered_map<HttpVersion, std::string> versionMessage_;
     static const std::unordered_map<HttpMethod, std::string> methodMessage_;
+    static const std::vector<std::string> statusLines_;     // 下标见statusLineIndex()
+    static std::string serverName_;
+    static std::string serverHeader_;                       // 预先编码好的Server首部行
     static std::unordered_map<HttpStatusCode, HttpResponsePtr> generalResponse_;
 
+    static constexpr size_t kMaxRequestHeadSize = 65536;   // 请求行和首部的最大总长度
+    static constexpr size_t kMaxContentLengthDigits = 18;  // Content-Length的最大位数，避免溢出
+    static constexpr size_t kMaxChunkSizeDigits = 15;      // 分块长度的最大位数（十六进制），避免溢出
+    static constexpr size_t kMaxChunkSizeLine = 4096;      // 分块长度行（含扩展）的最大长度
+    static constexpr size_t kMaxCopiedBodySize = 16384;   // 不超过该长度的响应体拷贝到首部之后发送
+    static constexpr size_t kMaxCoalescedSize = 65536;     // 合并发送的响应达到该长度后先行发送
+    static constexpr size_t kMaxPipelinedOutputSize = 1024 * 1024;    // 发送缓冲中待发送数据的上限，超过后暂停处理流水线中的后续请求
+    static constexpr size_t kMaxStreamingBufferedSize = 65536;    // 分块发送时待发送数据的上限，超过后等待写完成回调再继续
+    static constexpr size_t kNumStatusCodes = 11;            // HttpStatusCode的个数
+    static constexpr const char * kDefaultServerName = "tinyserver/1.2.1";
+
     static const std::string crlf;
     static const std::string space;
     static const std::string colon;
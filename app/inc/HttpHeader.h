@@ -0,0 +1,49 @@
+#ifndef __HTTPHEADER_H__
+#define __HTTPHEADER_H__
+
+#include <boost/utility.hpp>
+#include <boost/utility/string_view.hpp>
+#include <string>
+
+// HTTP首部名称相关的工具函数
+// 常用首部预先编号，解析时为每个首部计算一次编号，此后按编号查找，只比较整数
+// 首部名称不区分大小写
+class HttpHeader: public boost::noncopyable {
+public:
+    enum Id {
+        kUnknown,                   // 不在下列之中的首部，须比较名称
+        kAccept,
+        kAcceptEncoding,
+        kAcceptRanges,
+        kConnection,
+        kContentEncoding,
+        kContentLength,
+        kContentRange,
+        kContentType,
+        kDate,
+        kETag,
+        kHost,
+        kIfModifiedSince,
+        kIfNoneMatch,
+        kIfRange,
+        kLastModified,
+        kRange,
+        kServer,
+        kTransferEncoding,
+        kUserAgent,
+        kVary,
+        kNumKnownHeaders
+    };
+
+    // 获取名称对应的编号，不是常用首部时返回kUnknown
+    static Id lookup(boost::string_view name);
+    // 常用首部的规范名称
+    static const std::string & name(Id id);
+    // 不区分大小写地比较两个字符串
+    static bool equals(boost::string_view lhs, boost::string_view rhs);
+
+private:
+    static const std::string names_[kNumKnownHeaders];
+};
+
+#endif //__HTTPHEADER_H__
@@ -2,59 +2,94 @@
 #define __HTTPREQUEST_H__
 
 #include <boost/utility.hpp>
+#include <boost/utility/string_view.hpp>
+#include <boost/container/small_vector.hpp>
 #include <string>
-#include <unordered_map>
 #include "HttpContext.h"
+#include "HttpHeader.h"
 
+// HTTP请求
+// 路径、参数、首部和请求体都是视图（boost::string_view），解码时直接引用TcpConnection的接收缓冲，不做拷贝
+// 接收缓冲中的请求数据在请求处理完毕之前不会被取走，因此视图只在服务函数执行期间有效，需要保留的数据须自行拷贝
+// 请求体跨越多次读取时，解码器会调用detach()将视图拷贝到请求自己的存储中
+// 首部按出现顺序存放在连续的内存中（通常不超过kInlineHeaders个，不分配堆内存），并记录常用首部的编号，查找时线性扫描
 class HttpRequest: public boost::noncopyable {
 public:
     using HttpMethod    = HttpContext::HttpMethod;
     using HttpVersion   = HttpContext::HttpVersion;
+    struct Header {
+        HttpHeader::Id id;              // 常用首部的编号（其他首部为kUnknown）
+        boost::string_view name;
+        boost::string_view value;
+    };
+    static constexpr size_t kInlineHeaders = 16;    // 不超过该数量的首部直接存放在请求对象中
+    using Headers       = boost::container::small_vector<Header, kInlineHeaders>;
 
     HttpRequest();
     ~HttpRequest();
 
     HttpMethod method() const;
     void setMethod(HttpMethod method);
-    void setMethod(const std::string & methodStr);
-    void setMethod(const char * begin, const char * end);
+    void setMethod(boost::string_view method);
 
     HttpVersion version() const;
     void setVersion(HttpVersion version);
-    void setVersion(const std::string & versionStr);
-    void setVersion(const char * begin, const char * end);
+    void setVersion(boost::string_view version);
 
-    const std::string & path() const;
-    void setPath(const std::string & path);
-    void setPath(const char * begin, const char * end);
+    boost::string_view path() const;
+    void setPath(boost::string_view path);
 
-    const std::string & query() const;
-    void setQuery(const std::string & query);
-    void setQuery(const char * begin, const char * end);
+    boost::string_view query() const;
+    void setQuery(boost::string_view query);
 
-    const std::string & body() const;
-    void setBody(const std::string & body);
-    void setBody(const char * begin, const char * end);
-    void appendBody(const std::string & body);
-    void appendBody(const char * begin, const char * end);
+    // 请求体超过kMaxBufferedBodySize后转存到临时文件中，此时body()为空，须通过bodyFile()读取
+    boost::string_view body() const;
+    // 引用外部内存中的完整请求体（不拷贝）
+    void setBody(boost::string_view body);
+    // 追加请求体（拷贝），转存临时文件失败时返回false
+    bool appendBody(const char * begin, const char * end);
+    // 请求体的总长度
+    size_t bodySize() const;
+    // 转存请求体的临时文件（创建后即删除，关闭时自动回收），未转存时返回-1
+    int bodyFile() const;
 
-    const std::string & getHeader(const std::string & key) const;
-    void setHeader(const std::string & key, const std::string & value);
-    void setHeader(const std::string & keyValueStr);
-    void setHeader(const char * begin, const char * end);
+    // 获取首部的值（名称不区分大小写），不存在时返回空视图
+    boost::string_view getHeader(boost::string_view key) const;
+    boost::string_view getHeader(HttpHeader::Id id) const;
+    // 设置首部，同名的首部已存在时替换其值
+    void setHeader(boost::string_view key, boost::string_view value);
+    // 同上，id为HttpHeader::lookup(key)的结果，解析时已经查找过编号，不必再查一次
+    void setHeader(HttpHeader::Id id, boost::string_view key, boost::string_view value);
 
-    const std::unordered_map<std::string, std::string> & headers() const;
+    const Headers & headers() const;
+
+    // 将引用外部内存的视图拷贝到请求自己的存储中，此后外部内存可以被修改或释放
+    void detach();
+    // 恢复到刚构造时的状态，保留各存储已分配的容量（过大的除外），供同一连接的下一个请求复用
+    void reset();
 
 private:
+    // 将请求体转存到临时文件中
+    bool spillBody();
+    // 关闭临时文件
+    void closeBodyFile();
+    // 将view拷贝到storage_的末尾（须预留足够的容量）并重新指向拷贝
+    void copyToStorage(boost::string_view & view);
+
     HttpMethod method_;
     HttpVersion version_;
-    std::string path_;
-    std::string query_;
-    std::unordered_map<std::string, std::string> headers_;
+    boost::string_view path_;
+    boost::string_view query_;
+    Headers headers_;
+    boost::string_view body_;           // 请求体（外部内存或ownedBody_）
+    std::string ownedBody_;             // 拷贝而来的请求体
+    size_t bodySize_;
+    int bodyFile_;
+    bool detached_;                     // 视图是否都已指向自己的存储
+    std::string storage_;               // detach()后路径、参数和首部的存储
 
-    static const std::string null;
-    static const std::unordered_map<std::string, HttpMethod> methodMap_;
-    static const std::unordered_map<std::string, HttpVersion> versionMap_;
+    static constexpr size_t kMaxBufferedBodySize = 1024 * 1024;     // 内存中缓存的最大请求体
+    static constexpr size_t kMaxRetainedSize = 65536;               // reset()时保留的最大存储容量
 };
 
 #endif //__HTTPREQUEST_H__
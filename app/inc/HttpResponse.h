@@ -2,15 +2,44 @@
 #define __HTTPRESPONSE_H__
 
 #include <boost/utility.hpp>
+#include <boost/utility/string_view.hpp>
+#include <boost/container/small_vector.hpp>
 #include <string>
-#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <vector>
+#include <sys/types.h>
 #include "HttpContext.h"
+#include "HttpHeader.h"
+
+class File;
 
 class HttpResponse: public boost::noncopyable {
 public:
     using HttpVersion       = HttpContext::HttpVersion;
     using HttpStatusCode    = HttpContext::HttpStatusCode;
 
+    // multipart响应体中的一个分段
+    struct BodyRange {
+        std::string header;     // 分段之前的分隔行和分段首部
+        off_t offset;           // 分段在文件（或外部内存）中的偏移
+        size_t length;          // 分段长度
+    };
+
+    // 分块传输（Transfer-Encoding: chunked）的响应体数据源，每次调用向chunk追加下一块数据，返回false表示响应体结束
+    // 只在发送缓冲中待发送的数据较少时才会被调用，因此可以边生成边发送而不必将整个响应体保存在内存中
+    // 返回true时须提供非空的数据
+    using ChunkProvider = std::function<bool(std::string * chunk)>;
+
+    // 首部按设置的顺序存放在连续的内存中，并记录常用首部的编号
+    struct Header {
+        HttpHeader::Id id;              // 常用首部的编号（其他首部为kUnknown）
+        std::string name;
+        std::string value;
+    };
+    static constexpr size_t kInlineHeaders = 8;     // 不超过该数量的首部直接存放在响应对象中
+    using Headers           = boost::container::small_vector<Header, kInlineHeaders>;
+
     HttpResponse();
     ~HttpResponse();
 
@@ -24,18 +53,66 @@ public:
 
     const std::string & body() const;
     void setBody(const std::string & body);
+    // 以外部内存作为响应体（不拷贝），holder须保证data在发送完毕前有效
+    void setBody(std::shared_ptr<const void> holder, const char * data, size_t size);
+    // 响应体的持有者，响应体在body_中时为nullptr
+    std::shared_ptr<const void> bodyHolder() const;
+    // 响应体的地址和长度（无论响应体在body_中还是外部内存中）
+    const char * bodyData() const;
+    size_t bodySize() const;
+
+    // 以文件作为响应体（发送时使用sendfile()），与body互斥
+    void setFile(std::shared_ptr<File> file, off_t offset, size_t length);
+    std::shared_ptr<File> file() const;
+    off_t fileOffset() const;
+    size_t fileLength() const;
+
+    // 设置multipart响应体：依次由每个分段的header及文件（或外部内存）中的对应区间组成，最后是trailer
+    // 须先通过setFile()或setBody(holder, data, size)设置分段所在的文件或外部内存
+    void setBodyRanges(std::vector<BodyRange> ranges, const std::string & trailer);
+    const std::vector<BodyRange> & bodyRanges() const;
+    const std::string & bodyTrailer() const;
+
+    // 以分块传输的方式发送响应体（不应设置Content-Length），与其他响应体互斥
+    void setChunkProvider(ChunkProvider provider);
+    const ChunkProvider & chunkProvider() const;
+
+    // 获取首部的值（名称不区分大小写），不存在时返回空字符串
+    const std::string & getHeader(boost::string_view key) const;
+    const std::string & getHeader(HttpHeader::Id id) const;
+    // 设置首部，同名的首部已存在时替换其值
+    void setHeader(boost::string_view key, boost::string_view value);
+    void setHeader(HttpHeader::Id id, boost::string_view value);
+    // 设置Content-Length首部（格式化长度时不分配内存）
+    void setContentLength(size_t length);
+
+    const Headers & headers() const;
+
+    // 设置预先编码好的首部行（每行以CRLF结尾），编码时原样追加在headers()之后
+    void setEncodedHeaders(std::shared_ptr<const void> holder, const std::string * encodedHeaders);
+    const std::string * encodedHeaders() const;
 
-    const std::string & getHeader(const std::string & key) const;
-    void setHeader(const std::string & key, const std::string & value);
-    
-    const std::unordered_map<std::string, std::string> & headers() const;
+    // 恢复到刚构造时的状态并释放持有的文件和外部内存，保留已分配的容量（过大的除外），供同一连接的下一个响应复用
+    void reset();
 private:
     HttpVersion version_;
     HttpStatusCode statusCode_;
     std::string body_;
-    std::unordered_map<std::string, std::string> headers_;
+    std::shared_ptr<const void> bodyHolder_;
+    const char * bodyData_;
+    size_t bodySize_;
+    std::shared_ptr<File> file_;
+    off_t fileOffset_;
+    size_t fileLength_;
+    std::vector<BodyRange> bodyRanges_;
+    std::string bodyTrailer_;
+    ChunkProvider chunkProvider_;
+    Headers headers_;
+    std::shared_ptr<const void> encodedHeadersHolder_;
+    const std::string * encodedHeaders_;
 
     static const std::string null;
+    static constexpr size_t kMaxRetainedSize = 65536;       // reset()时保留的最大响应体容量
 };
 
 #endif //__HTTPRESPONSE_H__
@@ -33,12 +33,30 @@ public:
     const std::string & name() const;
     const InetAddress & localAddress() const;
 
+    // 设置keep-alive连接的空闲超时时间（秒），小于等于0表示不启用，须在start()之前调用
+    void setIdleTimeout(double seconds);
+    // 设置是否使用边缘触发，须在start()之前调用
+    void setEdgeTriggered(bool enabled);
+    // 设置是否每个IO线程各自监听端口（SO_REUSEPORT），须在start()之前调用
+    void setReusePort(bool enabled);
+    // 设置静态文件缓存的容量（字节），为0时不缓存，须在start()之前调用
+    void setFileCacheSize(size_t capacity);
+    // 设置中等大小文件的mmap缓存的容量（字节），为0时不映射，须在start()之前调用
+    void setMmapCacheSize(size_t capacity);
+    // 设置gzip编码后内容的缓存容量（字节），为0时不缓存，须在start()之前调用
+    void setGzipCacheSize(size_t capacity);
+    // 设置Server首部中的服务器名称，须在start()之前调用
+    void setServerName(const std::string & name);
+
     void start(int numThreads = 4);
     void stop();
 
 private:
+    // 在每个IO线程中启动Date首部的缓存
+    void handleThreadInit(EventLoop * loop);
     void handleConnection(TcpConnectionPtr conn);
     void handleMessage(TcpConnectionPtr conn, BufferPtr message, TimeStamp receiveTime);
+    void handleWriteComplete(TcpConnectionPtr conn);
 
     EventLoop * loop_;
     const std::string name_;
@@ -47,6 +65,9 @@ private:
     std::unique_ptr<HttpService> service_;
 
     bool started_;
+    double idleTimeout_;
+    bool edgeTriggered_;
+    bool reusePort_;
     std::unique_ptr<TcpServer> tcpServer_;
 
     MutexLock mutex_;
@@ -2,12 +2,20 @@
 #define __HTTPSERVICE_H__
 
 #include <boost/utility.hpp>
+#include <boost/utility/string_view.hpp>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <sys/types.h>
+#include <ctime>
 #include "HttpContext.h"
 
 class HttpRequest;
 class HttpResponse;
+class File;
+class FileCache;
 
 class HttpService: public boost::noncopyable {
 public:
@@ -21,14 +29,66 @@ public:
     ~HttpService();
 
     void service(HttpRequestPtr request, HttpResponsePtr response);
+    // 设置静态文件缓存的容量（字节），为0时不缓存，须在处理请求之前调用
+    void setFileCacheSize(size_t capacity);
+    // 设置中等大小文件的mmap缓存的容量（字节，即映射的总大小），为0时不映射，须在处理请求之前调用
+    void setMmapCacheSize(size_t capacity);
+    // 设置gzip编码后内容的缓存容量（字节），为0时不缓存（仍会使用预先压缩好的.gz文件），须在处理请求之前调用
+    void setGzipCacheSize(size_t capacity);
+
+    // 根据文件扩展名获取Content-Type
+    static const std::string & getContentType(const std::string & path);
+    // 根据文件大小和修改时间生成强ETag，encoding非空时（如gzip）附加在ETag中以区分同一文件的不同编码
+    static std::string generateETag(off_t size, const struct timespec & modifyTime, const std::string & encoding = std::string());
+    // 打开与file对应的预先压缩好的path.gz，不存在或早于原文件（可能已过期）时返回nullptr
+    static std::shared_ptr<File> openPrecompressed(const File & file);
+    static std::shared_ptr<File> openPrecompressed(const std::string & path, const struct stat & st);
 
 private:
     void doGet(HttpRequestPtr request, HttpResponsePtr response);
     void doPost(HttpRequestPtr request, HttpResponsePtr response);
 
+    // 以文件作为响应体发送静态文件，客户端接受gzip且存在不早于原文件的path.gz时发送后者
+    void serveFile(HttpRequestPtr request, HttpResponsePtr response, std::shared_ptr<File> file);
+    // 判断请求和Content-Type是否允许使用gzip编码
+    static bool acceptGzip(HttpRequestPtr request, const std::string & contentType);
+    // 以缓存的文件内容作为响应体发送静态文件，文件不适合缓存时返回false
+    bool serveCachedFile(HttpRequestPtr request, HttpResponsePtr response, const std::string & realPath);
+    // 闭区间[first, second]
+    using ByteRange = std::pair<off_t, off_t>;
+    // 根据If-None-Match和If-Modified-Since判断客户端缓存的版本是否仍然有效
+    bool isNotModified(HttpRequestPtr request, const std::string & etag, time_t modifyTime);
+    // 判断以逗号分隔的ETag列表header中是否有与etag匹配的项，weak为true时使用弱比较
+    static bool matchETag(boost::string_view header, const std::string & etag, bool weak);
+    // 设置304响应
+    void setNotModifiedResponse(HttpResponsePtr response, const std::string & etag, const std::string & lastModified);
+    // 解析Range首部，Range不存在、语法错误、If-Range不匹配或区间过多时返回false（返回完整内容），否则将可满足的区间存入ranges
+    bool parseRange(HttpRequestPtr request, off_t size, const std::string & etag, const std::string & lastModified, std::vector<ByteRange> & ranges);
+    // 根据ranges设置206或416响应，响应体的来源（文件或外部内存）须已设置为完整内容
+    void setRangeResponse(HttpResponsePtr response, const std::vector<ByteRange> & ranges, off_t size, const std::string & contentType, const std::string & etag, const std::string & lastModified);
+    // 生成multipart的分隔符
+    static std::string generateBoundary();
+    // 根据请求设置Connection首部
+    void setConnectionHeader(HttpRequestPtr request, HttpResponsePtr response);
+    // 将请求路径映射为服务器上的文件路径
+    std::string getRealPath(HttpRequestPtr request) const;
+
     HttpResponsePtr executeCgi(HttpRequestPtr request);
+    // 将请求体（内存中的或已转存到临时文件中的）写入fd
+    static void writeRequestBody(HttpRequestPtr request, int fd);
 
     const std::string root_;
+    std::unique_ptr<FileCache> fileCache_;     // 小文件读入堆内存缓存
+    std::unique_ptr<FileCache> mmapCache_;     // 中等大小的文件映射到内存缓存
+    std::unique_ptr<FileCache> gzipCache_;     // 文本类文件gzip编码后的内容缓存
+
+    static constexpr size_t kMaxReadFileSize = 1024 * 1024;         // 读入堆内存的最大文件
+    static constexpr size_t kMaxRanges = 16;           // 一个请求最多的区间数目
+    static constexpr size_t kMaxRangeDigits = 18;      // 区间端点的最大位数，避免溢出
+    static constexpr size_t kMaxMmapFileSize = 64 * 1024 * 1024;    // 映射到内存的最大文件，更大的文件使用sendfile()发送
+
+    static const std::unordered_map<std::string, std::string> contentTypes_;
+    static const std::string defaultContentType_;
 };
 
 #endif //__HTTPSERVICE_H__
@@ -15,6 +15,10 @@ int main(int argc, char * argv[]) {
     mainLoop = &loop;
 
     HttpServer httpServer(mainLoop, "HttpServer", InetAddress("0.0.0.0", 2222), "./www");
+    httpServer.setIdleTimeout(60);
+    httpServer.setFileCacheSize(64 * 1024 * 1024);
+    httpServer.setMmapCacheSize(1024 * 1024 * 1024);
+    httpServer.setGzipCacheSize(32 * 1024 * 1024);
     httpServer.start();
     mainLoop->loop();
 
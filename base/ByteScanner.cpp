@@ -0,0 +1,109 @@
+#include "ByteScanner.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BYTESCANNER_X86
+#endif
+
+using FindFunction = ByteScanner::FindFunction;
+
+struct ScannerImplementation {
+    const char * name;
+    FindFunction findEither;
+};
+
+static const char * findEitherScalar(const char * begin, const char * end, char c1, char c2) {
+    for(const char * it = begin; it < end; ++it) {
+        if(*it == c1 || *it == c2) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+#ifdef BYTESCANNER_X86
+__attribute__((target("sse2")))
+static const char * findEitherSse2(const char * begin, const char * end, char c1, char c2) {
+    const __m128i pattern1 = _mm_set1_epi8(c1);
+    const __m128i pattern2 = _mm_set1_epi8(c2);
+    const char * it = begin;
+    for(; end - it >= 16; it += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(it));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, pattern1), _mm_cmpeq_epi8(block, pattern2)));
+        if(mask != 0) {
+            return it + __builtin_ctz(mask);
+        }
+    }
+    // 不足16字节的尾部逐字节比较
+    return findEitherScalar(it, end, c1, c2);
+}
+
+__attribute__((target("avx2")))
+static const char * findEitherAvx2(const char * begin, const char * end, char c1, char c2) {
+    const __m256i pattern1 = _mm256_set1_epi8(c1);
+    const __m256i pattern2 = _mm256_set1_epi8(c2);
+    const char * it = begin;
+    for(; end - it >= 32; it += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(it));
+        unsigned int mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, pattern1), _mm256_cmpeq_epi8(block, pattern2)));
+        if(mask != 0) {
+            return it + __builtin_ctz(mask);
+        }
+    }
+    return findEitherSse2(it, end, c1, c2);
+}
+#endif
+
+static FindFunction supportedImplementation(const char * name) {
+    if(::strcmp(name, "scalar") == 0) {
+        return findEitherScalar;
+    }
+#ifdef BYTESCANNER_X86
+    __builtin_cpu_init();
+    if(::strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        return findEitherAvx2;
+    }
+    if(::strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+        return findEitherSse2;
+    }
+#endif
+    return nullptr;
+}
+
+static ScannerImplementation selectImplementation() {
+    if(::getenv("TINYSERVER_DISABLE_SIMD") == nullptr) {
+        // 按从快到慢的顺序选择
+        static const char * const names[] = {"avx2", "sse2"};
+        for(const char * name : names) {
+            FindFunction findEither = supportedImplementation(name);
+            if(findEither != nullptr) {
+                return ScannerImplementation{name, findEither};
+            }
+        }
+    }
+    return ScannerImplementation{"scalar", findEitherScalar};
+}
+
+// 首次使用时选择实现，之后不再改变
+static const ScannerImplementation & currentImplementation() {
+    static const ScannerImplementation implementation = selectImplementation();
+    return implementation;
+}
+
+const char * ByteScanner::find(const char * begin, const char * end, char c) {
+    return currentImplementation().findEither(begin, end, c, c);
+}
+
+const char * ByteScanner::findEither(const char * begin, const char * end, char c1, char c2) {
+    return currentImplementation().findEither(begin, end, c1, c2);
+}
+
+const char * ByteScanner::implementation() {
+    return currentImplementation().name;
+}
+
+FindFunction ByteScanner::implementationOf(const char * name) {
+    return supportedImplementation(name);
+}
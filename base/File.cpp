@@ -0,0 +1,59 @@
+#include "File.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <strings.h>
+#include <errno.h>
+
+File::File(const std::string & path)
+    : path_(path)
+    , fd_(::open(path_.c_str(), O_RDONLY | O_CLOEXEC))
+    , error_(fd_ == -1 ? errno : 0) {
+    bzero(&stat_, sizeof(stat_));
+    if(fd_ != -1 && ::fstat(fd_, &stat_) == -1) {
+        error_ = errno;
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+File::~File() {
+    if(fd_ != -1) {
+        ::close(fd_);
+    }
+}
+
+bool File::valid() const {
+    return fd_ != -1;
+}
+
+int File::error() const {
+    return error_;
+}
+
+int File::fd() const {
+    return fd_;
+}
+
+const std::string & File::path() const {
+    return path_;
+}
+
+bool File::isRegular() const {
+    return S_ISREG(stat_.st_mode);
+}
+
+bool File::isExecutable() const {
+    return stat_.st_mode & S_IXUSR;
+}
+
+off_t File::size() const {
+    return stat_.st_size;
+}
+
+time_t File::modifyTime() const {
+    return stat_.st_mtime;
+}
+
+const struct stat & File::status() const {
+    return stat_;
+}
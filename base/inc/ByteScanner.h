@@ -0,0 +1,22 @@
+#ifndef __BYTESCANNER_H__
+#define __BYTESCANNER_H__
+
+#include <boost/utility.hpp>
+
+// 在内存中查找指定字节，每次比较16（SSE2）或32（AVX2）个字节
+// 启动后根据cpuid的结果选择CPU支持的最快实现，设置了环境变量TINYSERVER_DISABLE_SIMD时使用逐字节比较的实现
+class ByteScanner: public boost::noncopyable {
+public:
+    using FindFunction = const char * (*)(const char * begin, const char * end, char c1, char c2);
+
+    // 查找[begin, end)中第一个等于c的字节，找不到时返回nullptr
+    static const char * find(const char * begin, const char * end, char c);
+    // 查找[begin, end)中第一个等于c1或c2的字节，找不到时返回nullptr
+    static const char * findEither(const char * begin, const char * end, char c1, char c2);
+    // 当前使用的实现（"avx2"、"sse2"或"scalar"）
+    static const char * implementation();
+    // 名为name（"avx2"、"sse2"或"scalar"）的findEither()实现，CPU不支持时返回nullptr，用于测试和基准测试比较各实现
+    static FindFunction implementationOf(const char * name);
+};
+
+#endif //__BYTESCANNER_H__
@@ -0,0 +1,42 @@
+#ifndef __FILE_H__
+#define __FILE_H__
+
+#include <boost/utility.hpp>
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// 以只读方式打开的文件，析构时自动关闭
+class File: public boost::noncopyable {
+public:
+    explicit File(const std::string & path);
+    ~File();
+
+    // 是否打开成功
+    bool valid() const;
+    // 打开失败时的errno
+    int error() const;
+    // 文件描述符
+    int fd() const;
+    // 文件路径
+    const std::string & path() const;
+
+    // 是否为普通文件
+    bool isRegular() const;
+    // 是否可被所有者执行
+    bool isExecutable() const;
+    // 文件大小
+    off_t size() const;
+    // 最后修改时间（秒）
+    time_t modifyTime() const;
+    // 打开时fstat()得到的完整状态
+    const struct stat & status() const;
+
+private:
+    const std::string path_;
+    int fd_;
+    int error_;
+    struct stat stat_;
+};
+
+#endif //__FILE_H__
@@ -0,0 +1,134 @@
+#ifndef __MPSCQUEUE_H__
+#define __MPSCQUEUE_H__
+
+#include <boost/utility.hpp>
+#include <atomic>
+#include <utility>
+
+// 无锁的多生产者单消费者队列（Dmitry Vyukov的链表队列）
+// push()可以在任意线程中并发调用，pop()只能在唯一的消费者线程中调用
+// T须可默认构造（用于哨兵节点）及可移动赋值
+// 节点不在每次push()/pop()时分配和释放：消费者把用过的节点放回队列的空闲链表，
+// 生产者一次取走整条空闲链表放入本线程的缓存，之后从缓存中分配
+template <typename T>
+class MpscQueue: public boost::noncopyable {
+public:
+    MpscQueue()
+        : head_(new Node())
+        , tail_(head_.load(std::memory_order_relaxed))
+        , numFreeNodes_(0)
+        , freeNodes_(nullptr) {
+    }
+
+    ~MpscQueue() {
+        T value;
+        while(pop(value)) {
+        }
+        delete tail_;
+        deleteNodes(freeNodes_.load(std::memory_order_acquire));
+    }
+
+    // 将value加入队列尾部（线程安全）
+    void push(T value) {
+        Node * node = allocateNode();
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->value = std::move(value);
+        // 先抢占队尾，再把前驱节点链接到新节点上，两步之间消费者会暂时看不到新节点
+        Node * prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // 从队列头部取出一个元素，队列为空（或生产者尚未完成链接）时返回false，只能在消费者线程中调用
+    bool pop(T & value) {
+        Node * tail = tail_;
+        Node * next = tail->next.load(std::memory_order_acquire);
+        if(next == nullptr) {
+            return false;
+        }
+        // next成为新的哨兵节点，其中的元素被移出
+        value = std::move(next->value);
+        tail_ = next;
+        recycleNode(tail);
+        return true;
+    }
+
+    // 判断队列是否为空，只能在消费者线程中调用
+    bool empty() const {
+        return tail_->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        Node(): next(nullptr), value() {}
+
+        std::atomic<Node *> next;   // 在队列中指向后继节点，在空闲链表中指向下一个空闲节点
+        T value;
+    };
+
+    // 生产者线程缓存的空闲节点，线程退出时释放（需要析构函数，因此不能使用__thread）
+    struct NodeCache {
+        NodeCache(): head(nullptr) {}
+        ~NodeCache() {
+            deleteNodes(head);
+        }
+
+        Node * head;
+    };
+
+    static void deleteNodes(Node * node) {
+        while(node != nullptr) {
+            Node * next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    // 从本线程的缓存中分配节点，缓存为空时取走消费者回收的整条空闲链表，仍为空才new
+    // 只用exchange()整体取走，不会出现逐个弹出时的ABA问题
+    Node * allocateNode() {
+        Node *& cache = nodeCache_.head;
+        if(cache == nullptr) {
+            cache = freeNodes_.exchange(nullptr, std::memory_order_acquire);
+            if(cache == nullptr) {
+                return new Node();
+            }
+        }
+        Node * node = cache;
+        cache = node->next.load(std::memory_order_relaxed);
+        return node;
+    }
+
+    // 消费者把用过的哨兵节点放回空闲链表，链表中的节点过多时直接释放
+    void recycleNode(Node * node) {
+        Node * head = freeNodes_.load(std::memory_order_relaxed);
+        if(head == nullptr) {
+            // 空闲链表已被生产者取走
+            numFreeNodes_ = 0;
+        }
+        if(numFreeNodes_ >= kMaxFreeNodes) {
+            delete node;
+            return ;
+        }
+        do {
+            node->next.store(head, std::memory_order_relaxed);
+        } while(!freeNodes_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+        ++numFreeNodes_;
+    }
+
+    static constexpr int kCacheLineSize = 64;
+    static constexpr size_t kMaxFreeNodes = 1024;  // 空闲链表长度的上限，突发大量任务后不长期占用内存
+
+    static thread_local NodeCache nodeCache_;
+
+    std::atomic<Node *> head_;  // 生产者写入的一端
+    char padding_[kCacheLineSize - sizeof(std::atomic<Node *>)];    // 使head_与tail_分处不同缓存行，避免伪共享
+    Node * tail_;               // 消费者读取的一端，始终指向哨兵节点
+    size_t numFreeNodes_;       // 消费者放回空闲链表的节点数目（被生产者取走后归零），只在消费者线程中访问
+    char padding2_[kCacheLineSize - sizeof(Node *) - sizeof(size_t)];
+    std::atomic<Node *> freeNodes_;     // 消费者回收的空闲节点
+};
+
+template <typename T>
+thread_local typename MpscQueue<T>::NodeCache MpscQueue<T>::nodeCache_;
+
+#endif //__MPSCQUEUE_H__
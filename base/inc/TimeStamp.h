@@ -20,7 +20,7 @@ public:
 
     static constexpr int64_t kMicroSecondsPerSecond = 1000 * 1000;
 private:
-    const int64_t microseconds_;
+    int64_t microseconds_;
 };
 
 bool operator<(const TimeStamp & lhs, const TimeStamp & rhs);
@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "ByteScanner.h"
+
+namespace {
+
+// 在长度为range(0)、只有最后一个字节匹配的缓冲中查找，相当于扫描一行首部找CRLF
+void BM_FindEither(benchmark::State & state, const char * name) {
+    ByteScanner::FindFunction findEither = ByteScanner::implementationOf(name);
+    if(findEither == nullptr) {
+        state.SkipWithError("not supported by this CPU");
+        return ;
+    }
+    std::string buffer(state.range(0), 'a');
+    buffer.back() = '\n';
+    const char * begin = buffer.data();
+    const char * end = begin + buffer.size();
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(findEither(begin, end, '\r', '\n'));
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+}
+
+BENCHMARK_CAPTURE(BM_FindEither, scalar, "scalar")->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(BM_FindEither, sse2, "sse2")->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK_CAPTURE(BM_FindEither, avx2, "avx2")->RangeMultiplier(4)->Range(16, 4096);
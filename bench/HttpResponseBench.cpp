@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include "HttpContext.h"
+#include "HttpResponse.h"
+#include "Buffer.h"
+
+namespace {
+
+using HttpResponsePtr = HttpContext::HttpResponsePtr;
+
+const std::string crlf("\r\n");
+const std::string space(" ");
+const std::string colon(": ");
+
+// 原先的编码方式：逐个片段写入Buffer，每次写入都检查并可能扩展空间，状态码每次转换为字符串
+void encodeByTokens(HttpResponsePtr response, Buffer * message) {
+    const auto & version = HttpContext::getVersionMessage(response->version());
+    message->write(version.data(), version.size());
+    message->write(space.data(), space.size());
+
+    std::string statusCode(std::to_string(static_cast<int>(response->statusCode())));
+    message->write(statusCode.data(), statusCode.size());
+    message->write(space.data(), space.size());
+
+    const auto & statusMsg = response->statusMessage();
+    message->write(statusMsg.data(), statusMsg.size());
+    message->write(crlf.data(), crlf.size());
+
+    for(const auto & header : response->headers()) {
+        message->write(header.name.data(), header.name.size());
+        message->write(colon.data(), colon.size());
+        message->write(header.value.data(), header.value.size());
+        message->write(crlf.data(), crlf.size());
+    }
+    message->write(crlf.data(), crlf.size());
+}
+
+// 静态文件的典型响应头，Date和Server已设置，两种编码方式的输出完全相同
+HttpResponsePtr makeResponse() {
+    HttpResponsePtr response(std::make_shared<HttpResponse>());
+    response->setVersion(HttpContext::kHttp11);
+    response->setStatusCode(HttpContext::kOk);
+    response->setHeader(HttpHeader::kDate, "Sun, 06 Nov 1994 08:49:37 GMT");
+    response->setHeader(HttpHeader::kServer, HttpContext::serverName());
+    response->setHeader(HttpHeader::kContentType, "text/html;charset=utf-8");
+    response->setContentLength(12345);
+    response->setHeader(HttpHeader::kLastModified, "Sun, 06 Nov 1994 08:49:37 GMT");
+    response->setHeader(HttpHeader::kETag, "\"5f3a-3039\"");
+    response->setHeader(HttpHeader::kAcceptRanges, "bytes");
+    response->setHeader(HttpHeader::kConnection, "keep-alive");
+    return response;
+}
+
+std::string encodeToString(void (*encode)(HttpResponsePtr, Buffer *), HttpResponsePtr response) {
+    Buffer message;
+    encode(response, &message);
+    return std::string(message.readBegin(), message.readableSize());
+}
+
+template <void (*Encode)(HttpResponsePtr, Buffer *)>
+void BM_EncodeResponseHead(benchmark::State & state) {
+    HttpResponsePtr response(makeResponse());
+    if(encodeToString(Encode, response) != encodeToString(&HttpContext::encodeHttpResponse, response)) {
+        state.SkipWithError("encoded heads differ");
+        return ;
+    }
+    // 与连接的发送缓冲一样重复使用同一个Buffer
+    Buffer message;
+    for(auto _ : state) {
+        Encode(response, &message);
+        benchmark::DoNotOptimize(message.readBegin());
+        message.hasRead(message.readableSize());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_EncodeResponseHead, encodeByTokens);
+BENCHMARK_TEMPLATE(BM_EncodeResponseHead, HttpContext::encodeHttpResponse);
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "MpscQueue.h"
+#include "Mutex.h"
+
+namespace {
+
+using Functor = std::function<void(void)>;
+
+// 原先EventLoop的任务队列：互斥锁保护的vector，消费者一次交换出全部任务
+class MutexTaskQueue: public boost::noncopyable {
+public:
+    void push(Functor task) {
+        MutexLockGuard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+
+    size_t runAll() {
+        std::vector<Functor> tasks;
+        {
+            MutexLockGuard lock(mutex_);
+            tasks.swap(tasks_);
+        }
+        for(Functor & task : tasks) {
+            task();
+        }
+        return tasks.size();
+    }
+
+private:
+    MutexLock mutex_;
+    std::vector<Functor> tasks_;
+};
+
+// 现在EventLoop的任务队列
+class LockFreeTaskQueue: public boost::noncopyable {
+public:
+    void push(Functor task) {
+        queue_.push(std::move(task));
+    }
+
+    size_t runAll() {
+        size_t count = 0;
+        Functor task;
+        while(queue_.pop(task)) {
+            task();
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    MpscQueue<Functor> queue_;
+};
+
+struct Counter {
+    size_t value = 0;
+};
+
+void increase(std::shared_ptr<Counter> counter) {
+    ++counter->value;
+}
+
+// 每个线程都投递任务，0号线程同时作为唯一的消费者执行任务，任务与runInLoop()中常见的一样绑定了一个shared_ptr
+template <typename Queue>
+void BM_TaskQueue(benchmark::State & state) {
+    static Queue queue;
+    std::shared_ptr<Counter> counter(std::make_shared<Counter>());
+    if(state.thread_index() == 0) {
+        // 上一轮残留的任务
+        queue.runAll();
+    }
+    for(auto _ : state) {
+        queue.push(std::bind(&increase, counter));
+        if(state.thread_index() == 0) {
+            benchmark::DoNotOptimize(queue.runAll());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+BENCHMARK_TEMPLATE(BM_TaskQueue, MutexTaskQueue)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TaskQueue, LockFreeTaskQueue)->ThreadRange(1, 8)->UseRealTime();
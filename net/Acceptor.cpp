@@ -8,10 +8,28 @@
 #include <glog/logging.h>
 #include <errno.h>
 #include <cstring>
+#include <cassert>
+#include <unistd.h>
+#include <fcntl.h>
 
 Acceptor::Acceptor(EventLoop * loop, const InetAddress & localAddr)
     : loop_(loop)
-    , listenning_(false) {
+    , listenning_(false)
+    , edgeTriggered_(false)
+    , acceptBatchSize_(kDefaultAcceptBatchSize)
+    , idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC))
+    , acceptedCount_(0)
+    , droppedCount_(0)
+    , wakeupCount_(0)
+    , lastAcceptedCount_(0)
+    , lastWakeupCount_(0)
+    , statsInterval_(kDefaultStatsInterval)
+    , statsTimer_()
+    , retryTimer_() {
+    if(idleFd_ == -1) {
+        LOG(FATAL) << "Something wrong when call open() in Acceptor::Acceptor(EventLoop * loop, const InetAddress & localAddr), the errno is " << errno << "(" << strerror(errno) << ")";
+    }
+
     int sockfd = ::socket(PF_INET, SOCK_STREAM, 0);
     if(sockfd == -1) {
         LOG(FATAL) << "Something wrong when call socket() in Acceptor::Acceptor(EventLoop * loop, const InetAddress & localAddr), the errno is " << errno << "(" << strerror(errno) << ")";
@@ -28,19 +46,53 @@ Acceptor::Acceptor(EventLoop * loop, const InetAddress & localAddr)
 }
 
 Acceptor::~Acceptor() {
-    channel_->disableReading();
-    channel_->remove();
+    if(listenning_) {
+        if(statsTimer_.valid()) {
+            loop_->cancel(statsTimer_);
+        }
+        if(retryTimer_.valid()) {
+            loop_->cancel(retryTimer_);
+        }
+        channel_->disableAll();
+        channel_->remove();
+    }
+    if(idleFd_ != -1) {
+        ::close(idleFd_);
+    }
+}
+
+EventLoop * Acceptor::getLoop() const {
+    return loop_;
 }
 
 void Acceptor::setNewConnectionCallback(NewConnectionCallback callback) {
     newConnectionCallback_ = callback;
 }
 
+void Acceptor::setEdgeTriggered(bool enabled) {
+    assert(!listenning_);
+    edgeTriggered_ = enabled;
+}
+
+void Acceptor::setAcceptBatchSize(int batchSize) {
+    assert(batchSize > 0);
+    acceptBatchSize_ = batchSize;
+}
+
+void Acceptor::setStatsInterval(double seconds) {
+    assert(!listenning_);
+    statsInterval_ = seconds;
+}
+
 void Acceptor::listen() {
     loop_->assertInLoopThread();
 
     socket_->listen();
     listenning_ = true;
+    if(statsInterval_ > 0.0) {
+        statsTimer_ = loop_->runEvery(statsInterval_, std::bind(&Acceptor::reportStats, this));
+    }
+    channel_->setEdgeTriggered(edgeTriggered_);
     channel_->enableReading();
 }
 
@@ -48,11 +100,129 @@ bool Acceptor::listenning() const {
     return listenning_;
 }
 
+void Acceptor::close() {
+    loop_->assertInLoopThread();
+
+    if(listenning_) {
+        listenning_ = false;
+        if(statsTimer_.valid()) {
+            loop_->cancel(statsTimer_);
+            statsTimer_ = TimerId();
+        }
+        if(retryTimer_.valid()) {
+            loop_->cancel(retryTimer_);
+            retryTimer_ = TimerId();
+        }
+        channel_->disableAll();
+        channel_->remove();
+    }
+}
+
 void Acceptor::handleRead() {
     loop_->assertInLoopThread();
+    ++wakeupCount_;
+    acceptConnections();
+}
+
+void Acceptor::acceptConnections() {
     InetAddress peerAddr(sockaddr_in{});
-    int ret = socket_->accept(peerAddr);
-    if(ret != -1 && newConnectionCallback_) {
-        newConnectionCallback_(ret, peerAddr);
+
+    // 一次可读事件中accept多个连接，边缘触发时必须一直accept直到EAGAIN，否则剩余的连接不会再触发事件
+    // 边缘触发时出错次数达到acceptBatchSize_或无法丢弃连接就停止，稍后由定时器重试，避免一直空转或连接滞留在队列中
+    int errors = 0;
+    for(int i = 0; edgeTriggered_ || i < acceptBatchSize_; ++i) {
+        if(errors >= acceptBatchSize_) {
+            scheduleRetry();
+            break;
+        }
+
+        int ret = socket_->accept(peerAddr);
+        if(ret == -1) {
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                // 没有新连接了
+                break;
+            } else if(errno == EMFILE || errno == ENFILE) {
+                // 文件描述符耗尽，丢弃这个连接，无法丢弃时等待下一次可读事件（边缘触发时等待重试）
+                if(!dropConnection()) {
+                    scheduleRetry();
+                    break;
+                }
+                continue;
+            } else {
+                // 连接在accept之前被对端关闭等暂时性错误，跳过这个连接
+                LOG(WARNING) << "Something wrong when call accept4() in Acceptor::handleRead(), the errno is " << errno << "(" << strerror(errno) << ")";
+                ++errors;
+                continue;
+            }
+        }
+
+        ++acceptedCount_;
+        if(newConnectionCallback_) {
+            newConnectionCallback_(ret, peerAddr);
+        } else {
+            ::close(ret);
+        }
     }
 }
+
+void Acceptor::scheduleRetry() {
+    // 水平触发时监听socket仍可读，下一次可读事件会继续accept
+    if(!edgeTriggered_ || retryTimer_.valid()) {
+        return ;
+    }
+    retryTimer_ = loop_->runAfter(kRetryDelay, std::bind(&Acceptor::handleRetry, this));
+}
+
+void Acceptor::handleRetry() {
+    loop_->assertInLoopThread();
+    retryTimer_ = TimerId();
+    if(listenning_) {
+        acceptConnections();
+    }
+}
+
+bool Acceptor::dropConnection() {
+    if(idleFd_ == -1) {
+        idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return false;
+    }
+
+    // 关闭预留的fd腾出位置，接收并立即关闭新连接，再重新预留
+    ::close(idleFd_);
+    int fd = ::accept(socket_->fd(), nullptr, nullptr);
+    bool dropped = fd != -1;
+    if(dropped) {
+        ::close(fd);
+        ++droppedCount_;
+        LOG(ERROR) << "Too many open files, drop a new connection (dropped " << droppedCount_ << " connections in total)";
+    }
+    idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return dropped;
+}
+
+void Acceptor::reportStats() {
+    loop_->assertInLoopThread();
+
+    uint64_t accepted = acceptedCount_ - lastAcceptedCount_;
+    uint64_t wakeups = wakeupCount_ - lastWakeupCount_;
+    lastAcceptedCount_ = acceptedCount_;
+    lastWakeupCount_ = wakeupCount_;
+
+    if(accepted > 0 || droppedCount_ > 0) {
+        LOG(INFO) << "Acceptor stats: " << accepted / statsInterval_ << " accepts/s, "
+                  << static_cast<double>(accepted) / (wakeups > 0 ? wakeups : 1) << " accepts/wakeup, "
+                  << acceptedCount_ << " accepted, " << droppedCount_ << " dropped in total";
+    }
+}
+
+uint64_t Acceptor::acceptedCount() const {
+    return acceptedCount_;
+}
+
+uint64_t Acceptor::droppedCount() const {
+    return droppedCount_;
+}
+
+uint64_t Acceptor::wakeupCount() const {
+    return wakeupCount_;
+}
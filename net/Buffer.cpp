@@ -1,16 +1,20 @@
 #include "Buffer.h"
 #include <cassert>
 #include <algorithm>
+#include <cstring>
 #include <unistd.h>
 #include <sys/uio.h>
 
 Buffer::Buffer(size_type initialSize)
-    : buffer_(initialSize)
+    : initialSize_(initialSize > 0 ? initialSize : kBufferInitialSize)
+    , buffer_(nullptr)
+    , capacity_(0)
     , readIndex_(0)
     , writeIndex_(0) {
 }
 
 Buffer::~Buffer() {
+    deallocate(buffer_, capacity_);
 }
 
 Buffer::size_type Buffer::readableSize() {
@@ -18,15 +22,19 @@ Buffer::size_type Buffer::readableSize() {
 }
 
 Buffer::size_type Buffer::writableSize() {
-    return buffer_.data() + buffer_.size() - writeBegin();
+    return capacity_ - writeIndex_;
+}
+
+Buffer::size_type Buffer::capacity() const {
+    return capacity_;
 }
 
 char * Buffer::readBegin() {
-    return buffer_.data() + readIndex_;
+    return buffer_ + readIndex_;
 }
 
 char * Buffer::writeBegin() {
-    return buffer_.data() + writeIndex_;
+    return buffer_ + writeIndex_;
 }
 
 void Buffer::hasRead(size_type size) {
@@ -41,7 +49,7 @@ void Buffer::hasRead(size_type size) {
 }
 
 void Buffer::hasWritten(size_type size) {
-    assert(writeBegin() + size <= buffer_.data() + buffer_.size());
+    assert(writeIndex_ + size <= capacity_);
 
     writeIndex_ += size;
 }
@@ -67,6 +75,10 @@ Buffer::size_type Buffer::writeFromFd(int fd, size_type size) {
         }
         return nBytes;
     } else {
+        if(capacity_ == 0) {
+            // 第一次读取前分配内存，避免数据全部先读到栈上再拷贝
+            ensure(initialSize_);
+        }
         char buf[size == -1 ? 65535 : size - writableSize()];
 
         struct iovec iov[2];
@@ -110,10 +122,67 @@ void Buffer::ensure(size_type size) {
     assert(size >= 0);
     
     if(writableSize() < size) {
-        int newsize = buffer_.size();
-        do {
+        size_type readable = readableSize();
+        size_type newsize = capacity_ > 0 ? capacity_ * 2 : initialSize_;
+        while(newsize < readable + size) {
             newsize *= 2;
-        } while(writableSize() < size);
-        buffer_.resize(newsize);
+        }
+
+        // 重新分配内存，并将未读数据移动到头部
+        char * newBuffer = allocate(newsize);
+        if(readable > 0) {
+            ::memcpy(newBuffer, readBegin(), readable);
+        }
+        deallocate(buffer_, capacity_);
+        buffer_ = newBuffer;
+        capacity_ = newsize;
+        readIndex_ = 0;
+        writeIndex_ = readable;
+    }
+}
+
+void Buffer::shrink() {
+    size_type readable = readableSize();
+    if(readable == 0) {
+        deallocate(buffer_, capacity_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        readIndex_ = 0;
+        writeIndex_ = 0;
+        return ;
+    }
+
+    if(capacity_ > kHighWaterSize) {
+        size_type newsize = initialSize_;
+        while(newsize < readable) {
+            newsize *= 2;
+        }
+        if(newsize < capacity_) {
+            char * newBuffer = allocate(newsize);
+            ::memcpy(newBuffer, readBegin(), readable);
+            deallocate(buffer_, capacity_);
+            buffer_ = newBuffer;
+            capacity_ = newsize;
+            readIndex_ = 0;
+            writeIndex_ = readable;
+        }
+    }
+}
+
+char * Buffer::allocate(size_type size) {
+    if(size == static_cast<size_type>(BufferPool::kBlockSize)) {
+        return BufferPool::allocate();
+    }
+    return new char[size];
+}
+
+void Buffer::deallocate(char * data, size_type size) {
+    if(data == nullptr) {
+        return ;
+    }
+    if(size == static_cast<size_type>(BufferPool::kBlockSize)) {
+        BufferPool::deallocate(data);
+    } else {
+        delete[] data;
     }
 }
@@ -0,0 +1,70 @@
+#include "BufferPool.h"
+
+// 线程退出时thread_local的池先于部分Buffer被销毁，此后的分配和归还直接使用new/delete
+__thread bool poolDestroyed = false;
+
+double BufferPool::Stats::hitRate() const {
+    uint64_t total = hits + misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+}
+
+BufferPool::BufferPool()
+    : freeBlocks_()
+    , hits_(0)
+    , misses_(0) {
+    freeBlocks_.reserve(kMaxFreeBlocks);
+}
+
+BufferPool::~BufferPool() {
+    for(char * block : freeBlocks_) {
+        delete[] block;
+    }
+    poolDestroyed = true;
+}
+
+char * BufferPool::allocate() {
+    BufferPool * pool = threadPool();
+    if(pool == nullptr) {
+        return new char[kBlockSize];
+    }
+
+    if(pool->freeBlocks_.empty()) {
+        ++pool->misses_;
+        return new char[kBlockSize];
+    }
+
+    ++pool->hits_;
+    char * block = pool->freeBlocks_.back();
+    pool->freeBlocks_.pop_back();
+    return block;
+}
+
+void BufferPool::deallocate(char * block) {
+    BufferPool * pool = threadPool();
+    if(pool == nullptr || pool->freeBlocks_.size() >= kMaxFreeBlocks) {
+        delete[] block;
+        return ;
+    }
+
+    pool->freeBlocks_.push_back(block);
+}
+
+BufferPool::Stats BufferPool::stats() {
+    Stats stats = {0, 0, 0, 0};
+    BufferPool * pool = threadPool();
+    if(pool != nullptr) {
+        stats.hits = pool->hits_;
+        stats.misses = pool->misses_;
+        stats.freeBlocks = pool->freeBlocks_.size();
+        stats.residentBytes = pool->freeBlocks_.size() * kBlockSize;
+    }
+    return stats;
+}
+
+BufferPool * BufferPool::threadPool() {
+    if(poolDestroyed) {
+        return nullptr;
+    }
+    static thread_local BufferPool pool;
+    return &pool;
+}
@@ -0,0 +1,154 @@
+#include "ChainBuffer.h"
+#include <cassert>
+#include <errno.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+
+bool ChainBuffer::Block::isFile() const {
+    return fileFd != -1;
+}
+
+const char * ChainBuffer::Block::readBegin() const {
+    assert(!isFile());
+    return buffer ? buffer->readBegin() : data;
+}
+
+ChainBuffer::size_type ChainBuffer::Block::readableSize() const {
+    return buffer ? buffer->readableSize() : size;
+}
+
+ChainBuffer::ChainBuffer()
+    : blocks_()
+    , readableSize_(0) {
+}
+
+ChainBuffer::~ChainBuffer() {
+}
+
+ChainBuffer::size_type ChainBuffer::readableSize() const {
+    return readableSize_;
+}
+
+size_t ChainBuffer::blockCount() const {
+    return blocks_.size();
+}
+
+void ChainBuffer::append(const void * data, size_type size) {
+    assert(size >= 0);
+    if(size == 0) {
+        return ;
+    }
+
+    // 尾部不是拷贝块时新建一个拷贝块，否则追加到尾部的Buffer中
+    if(blocks_.empty() || !blocks_.back().buffer) {
+        Block block;
+        block.buffer.reset(new Buffer(size > kMinCopyBlockSize ? size : kMinCopyBlockSize));
+        block.data = nullptr;
+        block.fileFd = -1;
+        block.offset = 0;
+        block.size = 0;
+        blocks_.push_back(std::move(block));
+    }
+    blocks_.back().buffer->write(static_cast<const char *>(data), size);
+    readableSize_ += size;
+}
+
+void ChainBuffer::append(Holder holder, const void * data, size_type size) {
+    assert(size >= 0);
+    if(size < kMinReferenceSize) {
+        append(data, size);
+        return ;
+    }
+
+    Block block;
+    block.holder = std::move(holder);
+    block.data = static_cast<const char *>(data);
+    block.fileFd = -1;
+    block.offset = 0;
+    block.size = size;
+    blocks_.push_back(std::move(block));
+    readableSize_ += size;
+}
+
+void ChainBuffer::appendFile(Holder holder, int fileFd, off_t offset, size_type size) {
+    assert(fileFd >= 0 && offset >= 0 && size >= 0);
+    if(size == 0) {
+        return ;
+    }
+
+    Block block;
+    block.holder = std::move(holder);
+    block.data = nullptr;
+    block.fileFd = fileFd;
+    block.offset = offset;
+    block.size = size;
+    blocks_.push_back(std::move(block));
+    readableSize_ += size;
+}
+
+ChainBuffer::size_type ChainBuffer::readIntoFd(int fd) {
+    if(blocks_.empty()) {
+        return 0;
+    }
+
+    if(blocks_.front().isFile()) {
+        // 头部是文件块，直接由内核从文件拷贝到socket
+        Block & block = blocks_.front();
+        off_t offset = block.offset;
+        size_type nBytes = ::sendfile(fd, block.fileFd, &offset, block.size);
+        if(nBytes > 0) {
+            hasRead(nBytes);
+        } else if(nBytes == 0) {
+            // 文件在发送过程中被截断，剩余数据永远无法发送
+            errno = EIO;
+            nBytes = -1;
+        }
+        return nBytes;
+    }
+
+    // 头部的连续内存块一次writev()输出，遇到文件块为止
+    struct iovec iov[kMaxIovecs];
+    int iovcnt = 0;
+    for(auto it = blocks_.begin(); it != blocks_.end() && !it->isFile() && iovcnt < kMaxIovecs; ++it) {
+        iov[iovcnt].iov_base = const_cast<char *>(it->readBegin());
+        iov[iovcnt].iov_len = it->readableSize();
+        ++iovcnt;
+    }
+
+    size_type nBytes = ::writev(fd, iov, iovcnt);
+    if(nBytes > 0) {
+        hasRead(nBytes);
+    }
+    return nBytes;
+}
+
+void ChainBuffer::hasRead(size_type size) {
+    assert(size >= 0 && size <= readableSize_);
+
+    readableSize_ -= size;
+    while(size > 0) {
+        Block & block = blocks_.front();
+        size_type blockSize = block.readableSize();
+        if(size < blockSize) {
+            // 头部块只输出了一部分
+            if(block.buffer) {
+                block.buffer->hasRead(size);
+            } else if(block.isFile()) {
+                block.offset += size;
+                block.size -= size;
+            } else {
+                block.data += size;
+                block.size -= size;
+            }
+            break;
+        }
+        // 头部块全部输出，释放（引用块同时释放对数据的持有）
+        size -= blockSize;
+        blocks_.pop_front();
+    }
+}
+
+void ChainBuffer::clear() {
+    blocks_.clear();
+    readableSize_ = 0;
+}
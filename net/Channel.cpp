@@ -2,16 +2,19 @@
 #include "TimeStamp.h"
 #include "EventLoop.h"
 #include <poll.h>
+#include <sys/epoll.h>
 
 const int Channel::kNoneEvent = 0;
 const int Channel::kReadEvent = POLLIN;
 const int Channel::kWriteEvent = POLLOUT;
+const int Channel::kEdgeTriggeredEvent = EPOLLET;
 
 Channel::Channel(EventLoop * loop, int fd)
     : loop_(loop)
     , fd_(fd)
     , events_(0)
-    , revents_(0) {
+    , revents_(0)
+    , edgeTriggered_(false) {
 }
 
 Channel::~Channel() {
@@ -26,7 +29,7 @@ int Channel::fd() const {
 }
 
 int Channel::events() const {
-    return events_;
+    return edgeTriggered_ ? events_ | kEdgeTriggeredEvent : events_;
 }
 
 void Channel::setRevents(int revents) {
@@ -99,6 +102,14 @@ bool Channel::isWriting() const {
     return static_cast<bool>(events_ & kWriteEvent);
 }
 
+void Channel::setEdgeTriggered(bool enabled) {
+    edgeTriggered_ = enabled;
+}
+
+bool Channel::isEdgeTriggered() const {
+    return edgeTriggered_;
+}
+
 void Channel::remove() {
     loop_->removeChannel(this);
 }
@@ -3,6 +3,9 @@
 #include "Poller.h"
 #include "Channel.h"
 #include "TimeStamp.h"
+#include "TimerQueue.h"
+#include "TimingWheel.h"
+#include "BufferPool.h"
 #include <sys/eventfd.h>
 #include <glog/logging.h>
 #include <cassert>
@@ -19,8 +22,10 @@ EventLoop::EventLoop()
     , callingPendingFunctors_(false)
     , threadId_(CurrentThread::tid())
     , poller_(Poller::createPoller(this))
-    , mutex_()
-    , pendingFunctors_() {
+    , timerQueue_(new TimerQueue(this))
+    , timingWheel_(new TimingWheel(this))
+    , pendingFunctors_()
+    , wakeupPending_(false) {
     if(wakeupFd_ == -1) {
         LOG(FATAL) << "Something wrong when call eventfd(), the errno is " << errno << "(" << strerror(errno) << ")";
     }
@@ -38,6 +43,9 @@ EventLoop::EventLoop()
 
 EventLoop::~EventLoop() {
     DLOG(INFO) << "Destroying EventLoop object in thread #" << threadId_;
+    BufferPool::Stats stats = BufferPool::stats();
+    DLOG(INFO) << "BufferPool of thread #" << threadId_ << ": hits = " << stats.hits << ", misses = " << stats.misses
+               << ", hit rate = " << stats.hitRate() << ", resident bytes = " << stats.residentBytes;
 }
 
 void EventLoop::loop() {
@@ -91,20 +99,41 @@ void EventLoop::runInLoop(Functor task) {
 }
 
 void EventLoop::queueInLoop(Functor task) {
-    {
-        MutexLockGuard lock(mutex_);
-        // 将task加入任务队列
-        pendingFunctors_.push_back(std::move(task));
-    }
+    // 将task加入任务队列
+    pendingFunctors_.push(std::move(task));
 
     // 判断是否需要唤醒loop，两种情况需要唤醒：
     // 1. 在非IO线程中调用了queueInLoop()
     // 2. 在执行任务队列中的task时
-    if(!isInLoopThread() || callingPendingFunctors_) {
+    // 如果已经有一次唤醒尚未被doPendingFunctors()处理，则本次task必然会在那次处理中被执行，不必再写eventfd
+    if((!isInLoopThread() || callingPendingFunctors_) && !wakeupPending_.exchange(true)) {
         wakeup();
     }
 }
 
+TimerId EventLoop::runAt(TimeStamp time, TimerCallback callback) {
+    return timerQueue_->addTimer(std::move(callback), time, 0.0);
+}
+
+TimerId EventLoop::runAfter(double delay, TimerCallback callback) {
+    TimeStamp time(TimeStamp::now().microseconds() + static_cast<int64_t>(delay * TimeStamp::kMicroSecondsPerSecond));
+    return runAt(time, std::move(callback));
+}
+
+TimerId EventLoop::runEvery(double interval, TimerCallback callback) {
+    TimeStamp time(TimeStamp::now().microseconds() + static_cast<int64_t>(interval * TimeStamp::kMicroSecondsPerSecond));
+    return timerQueue_->addTimer(std::move(callback), time, interval);
+}
+
+void EventLoop::cancel(TimerId timerId) {
+    timerQueue_->cancel(timerId);
+}
+
+TimingWheel * EventLoop::timingWheel() {
+    assertInLoopThread();
+    return timingWheel_.get();
+}
+
 void EventLoop::wakeup() {
     int64_t one = 1;
     int nBytes = ::write(wakeupFd_, &one, sizeof(one));
@@ -161,16 +190,18 @@ void EventLoop::doPendingFunctors() {
     std::vector<Functor> functors;
     callingPendingFunctors_ = true;
 
-    {
-        MutexLockGuard lock(mutex_);
-        // 将pengdingFunctors_中的元素交换到局部的functors中，减小临界区
-        functors.swap(pendingFunctors_);
+    // 先清除唤醒标志再取出task：此后加入的task要么被本次取出，要么其生产者会看到标志为false而重新唤醒loop
+    wakeupPending_.exchange(false);
+    // 将队列中当前可见的task取出到局部的functors中，执行期间新加入的task留到下一轮处理
+    Functor task;
+    while(pendingFunctors_.pop(task)) {
+        functors.push_back(std::move(task));
     }
 
     // functors是局部变量，不与其他线程共享，因此不需要加锁
-    for(Functor task : functors) {
-        if(task) {
-            task();
+    for(Functor & functor : functors) {
+        if(functor) {
+            functor();
         }
     }
 
@@ -0,0 +1,358 @@
+#include "IoUringPoller.h"
+#include "TimeStamp.h"
+#include "Channel.h"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cassert>
+#include <cstring>
+#include <glog/logging.h>
+
+// 创建io_uring并检查所需的特性，失败返回-1
+static int createRing(unsigned entries, unsigned cqEntries, struct io_uring_params & params) {
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = cqEntries;
+
+    int ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if(ringFd < 0) {
+        return -1;
+    }
+
+    // NODROP保证完成队列溢出时不丢失事件，EXT_ARG用于在io_uring_enter()中指定超时时间
+    // RSRC_TAGS与multishot poll同时出现（5.13），边缘触发的channel需要multishot poll
+    if(!(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_RSRC_TAGS)) {
+        ::close(ringFd);
+        return -1;
+    }
+    return ringFd;
+}
+
+// EPOLLET不能直接用于io_uring的poll请求，边缘触发通过multishot poll实现
+static uint32_t pollEvents(Channel * channel) {
+    return static_cast<uint32_t>(channel->events()) & ~static_cast<uint32_t>(EPOLLET);
+}
+
+IoUringPoller::IoUringPoller(EventLoop * loop)
+    : Poller(loop)
+    , ringFd_(-1)
+    , sqRing_(MAP_FAILED)
+    , sqRingSize_(0)
+    , sqHead_(nullptr)
+    , sqTail_(nullptr)
+    , sqMask_(nullptr)
+    , sqArray_(nullptr)
+    , sqEntries_(0)
+    , sqLocalTail_(0)
+    , sqes_(nullptr)
+    , cqRing_(MAP_FAILED)
+    , cqRingSize_(0)
+    , cqHead_(nullptr)
+    , cqTail_(nullptr)
+    , cqMask_(nullptr)
+    , cqes_(nullptr)
+    , generation_(0)
+    , states_()
+    , pendingFds_() {
+    if(!setupRing()) {
+        LOG(FATAL) << "Can't create io_uring, the errno is " << errno << "(" << strerror(errno) << ")";
+    }
+}
+
+IoUringPoller::~IoUringPoller() {
+    if(sqes_ != nullptr) {
+        ::munmap(sqes_, sqEntries_ * sizeof(struct io_uring_sqe));
+    }
+    if(cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+        ::munmap(cqRing_, cqRingSize_);
+    }
+    if(sqRing_ != MAP_FAILED) {
+        ::munmap(sqRing_, sqRingSize_);
+    }
+    if(ringFd_ >= 0) {
+        ::close(ringFd_);
+    }
+}
+
+TimeStamp IoUringPoller::poll(int timeoutMs, ChannelList & activeChannels) {
+    assertInLoopThread();
+    DLOG(INFO) << "Size of channels_ = " << channels_.size();
+
+    // 提交上一轮中新增、修改和已触发的channel的poll请求
+    for(int fd : pendingFds_) {
+        auto it = states_.find(fd);
+        if(it == states_.end()) {
+            // 已经被移除
+            continue;
+        }
+        it->second.queued = false;
+        if(!it->second.armed) {
+            armChannel(channels_[fd], it->second);
+        }
+    }
+    pendingFds_.clear();
+
+    // 提交所有请求并等待事件，整个过程只有一次系统调用
+    int ret = enter(1, timeoutMs);
+    TimeStamp now = TimeStamp::now();
+    if(ret < 0 && errno != EINTR && errno != ETIME && errno != EBUSY) {
+        LOG(FATAL) << "Something wrong when call io_uring_enter(), the errno is " << errno << "(" << strerror(errno) << ")";
+    }
+
+    // 收割完成事件，填充activeChannels
+    activeChannels.clear();
+    std::vector<int> activeFds;
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for(; head != tail; ++head) {
+        const struct io_uring_cqe & cqe = cqes_[head & *cqMask_];
+        if(cqe.user_data == kCancelUserData) {
+            continue;
+        }
+
+        int fd = static_cast<int>(cqe.user_data & 0xffffffff);
+        auto it = states_.find(fd);
+        if(it == states_.end() || !it->second.armed || it->second.userData != cqe.user_data) {
+            // 已被取消或修改的poll请求
+            continue;
+        }
+
+        PollState & state = it->second;
+        if(!(cqe.flags & IORING_CQE_F_MORE)) {
+            // 一次性的poll请求（或已终止的multishot poll）需要重新提交
+            state.armed = false;
+            queueFd(fd, state);
+        }
+
+        if(cqe.res > 0) {
+            // multishot poll在一轮中可能产生多个完成事件，合并到一起
+            if(state.revents == 0) {
+                activeFds.push_back(fd);
+            }
+            state.revents |= cqe.res;
+        } else if(cqe.res < 0) {
+            DLOG(INFO) << "Poll request on fd = " << fd << " completed with error " << -cqe.res << "(" << strerror(-cqe.res) << ")";
+        }
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+    for(int fd : activeFds) {
+        PollState & state = states_[fd];
+        ChannelPtr channel = channels_[fd];
+        assert(hasChannel(channel));
+        channel->setRevents(state.revents);
+        state.revents = 0;
+        activeChannels.push_back(channel);
+    }
+
+    if(!activeChannels.empty()) {
+        DLOG(INFO) << "io_uring caught " << activeChannels.size() << " events";
+    } else if(ret < 0 && errno == ETIME) {
+        DLOG(INFO) << "io_uring timeout after " << timeoutMs << " ms";
+    }
+
+    return now;
+}
+
+void IoUringPoller::updateChannel(ChannelPtr channel) {
+    assertInLoopThread();
+
+    int fd = channel->fd();
+    if(hasChannel(channel)) {
+        // 更新channel，已提交的poll请求关注的事件与新的不一致时需要取消后重新提交
+        PollState & state = states_[fd];
+        if(!state.armed || state.events != pollEvents(channel)) {
+            if(state.armed) {
+                cancelPoll(state);
+            }
+            queueFd(fd, state);
+        }
+        DLOG(INFO) << "Modified io_uring poll, fd = " << fd << ", events = " << channel->events();
+    } else {
+        // 添加channel
+        channels_.insert({fd, channel});
+        PollState & state = states_[fd];
+        state.userData = 0;
+        state.events = 0;
+        state.revents = 0;
+        state.armed = false;
+        state.queued = false;
+        queueFd(fd, state);
+        DLOG(INFO) << "Added io_uring poll, fd = " << fd << ", events = " << channel->events();
+    }
+}
+
+void IoUringPoller::removeChannel(ChannelPtr channel) {
+    assertInLoopThread();
+    assert(hasChannel(channel));
+
+    int fd = channel->fd();
+    auto it = states_.find(fd);
+    if(it != states_.end()) {
+        if(it->second.armed) {
+            cancelPoll(it->second);
+        }
+        states_.erase(it);
+    }
+    channels_.erase(fd);
+    DLOG(INFO) << "Deleted io_uring poll, fd = " << fd << ", events = " << channel->events();
+}
+
+bool IoUringPoller::isSupported() {
+    // 函数内的静态变量只会被初始化一次（线程安全）
+    static const bool supported = []() {
+        struct io_uring_params params;
+        int ringFd = createRing(kSqEntries, kCqEntries, params);
+        if(ringFd < 0) {
+            return false;
+        }
+        ::close(ringFd);
+        return true;
+    }();
+    return supported;
+}
+
+bool IoUringPoller::setupRing() {
+    struct io_uring_params params;
+    ringFd_ = createRing(kSqEntries, kCqEntries, params);
+    if(ringFd_ < 0) {
+        return false;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if(singleMmap) {
+        // 提交队列和完成队列共用一次映射
+        sqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        cqRingSize_ = sqRingSize_;
+    }
+
+    sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    if(sqRing_ == MAP_FAILED) {
+        return false;
+    }
+    if(singleMmap) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+        if(cqRing_ == MAP_FAILED) {
+            return false;
+        }
+    }
+
+    void * sqes = ::mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+    if(sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+
+    char * sq = static_cast<char *>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqMask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    sqEntries_ = params.sq_entries;
+    sqLocalTail_ = *sqTail_;
+
+    char * cq = static_cast<char *>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqMask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+struct io_uring_sqe * IoUringPoller::getSqe() {
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if(sqLocalTail_ - head >= sqEntries_) {
+        // 提交队列已满，先提交已有的请求（不等待）
+        if(enter(0, 0) < 0 && errno != EINTR && errno != EBUSY) {
+            LOG(FATAL) << "Something wrong when call io_uring_enter(), the errno is " << errno << "(" << strerror(errno) << ")";
+        }
+        head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        assert(sqLocalTail_ - head < sqEntries_);
+    }
+
+    unsigned index = sqLocalTail_ & *sqMask_;
+    struct io_uring_sqe * sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray_[index] = index;
+    ++sqLocalTail_;
+    return sqe;
+}
+
+void IoUringPoller::armChannel(ChannelPtr channel, PollState & state) {
+    assert(!state.armed);
+
+    uint32_t events = pollEvents(channel);
+    if(events == 0) {
+        return ;
+    }
+
+    // user_data的高32位为序号，低32位为fd，序号用于区分同一fd上先后提交的poll请求
+    ++generation_;
+    if(generation_ == 0) {
+        ++generation_;
+    }
+    state.userData = (static_cast<uint64_t>(generation_) << 32) | static_cast<uint32_t>(channel->fd());
+    state.events = events;
+    state.armed = true;
+
+    struct io_uring_sqe * sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = channel->fd();
+    sqe->poll32_events = events;
+    sqe->user_data = state.userData;
+    if(channel->isEdgeTriggered()) {
+        // multishot poll只在fd被唤醒时产生完成事件，语义与EPOLLET相同，并且不需要重新提交
+        sqe->len = IORING_POLL_ADD_MULTI;
+    }
+}
+
+void IoUringPoller::cancelPoll(PollState & state) {
+    assert(state.armed);
+
+    struct io_uring_sqe * sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = state.userData;
+    sqe->user_data = kCancelUserData;
+
+    state.armed = false;
+}
+
+void IoUringPoller::queueFd(int fd, PollState & state) {
+    if(!state.queued) {
+        state.queued = true;
+        pendingFds_.push_back(fd);
+    }
+}
+
+int IoUringPoller::enter(unsigned waitNr, int timeoutMs) {
+    // 发布新的提交队列尾部
+    __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+    unsigned toSubmit = sqLocalTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+
+    struct __kernel_timespec ts;
+    memset(&ts, 0, sizeof(ts));
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    unsigned flags = 0;
+    if(waitNr > 0) {
+        flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        arg.sigmask_sz = _NSIG / 8;
+        if(timeoutMs >= 0) {
+            ts.tv_sec = timeoutMs / 1000;
+            ts.tv_nsec = (timeoutMs % 1000) * 1000 * 1000;
+            arg.ts = reinterpret_cast<uint64_t>(&ts);
+        }
+    }
+
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd_, toSubmit, waitNr, flags, waitNr > 0 ? &arg : nullptr, sizeof(arg)));
+}
@@ -1,7 +1,10 @@
 #include "Poller.h"
 #include "Channel.h"
 #include "EpollPoller.h"
+#include "IoUringPoller.h"
 #include "EventLoop.h"
+#include <cstdlib>
+#include <glog/logging.h>
 
 Poller::Poller(EventLoop * loop)
     : loop_(loop) {
@@ -25,5 +28,12 @@ void Poller::assertInLoopThread() const {
 }
 
 Poller::PollerPtr Poller::createPoller(EventLoop * loop) {
+    // 设置了环境变量TINYSERVER_USE_IOURING时使用io_uring，内核不支持时回退到epoll
+    if(::getenv("TINYSERVER_USE_IOURING") != nullptr) {
+        if(IoUringPoller::isSupported()) {
+            return PollerPtr(new IoUringPoller(loop));
+        }
+        LOG(WARNING) << "io_uring is not supported by the kernel, fall back to epoll";
+    }
     return PollerPtr(new EpollPoller(loop));
 }
\ No newline at end of file
@@ -41,6 +41,21 @@ int Socket::accept(InetAddress & peerAddr) {
     socklen_t len = sizeof(addr);
     int ret = ::accept4(fd_, reinterpret_cast<struct sockaddr *>(&addr), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
     if(ret == -1) {
+        switch(errno) {
+            // 暂时没有新连接、连接在accept之前被对端关闭、文件描述符或内存耗尽等，由调用者根据errno处理
+            case EAGAIN:
+            case EINTR:
+            case ECONNABORTED:
+            case EPROTO:
+            case EPERM:
+            case EMFILE:
+            case ENFILE:
+            case ENOBUFS:
+            case ENOMEM:
+                return ret;
+            default:
+                break;
+        }
         LOG(FATAL) << "Something wrong when call accept4() in Socket::accept(InetAddress & peerAddr), the errno is " << errno << "(" << strerror(errno) << ")";
     }
     peerAddr = addr;
@@ -5,6 +5,7 @@
 #include "Socket.h"
 #include <glog/logging.h>
 #include <cassert>
+#include <sys/sendfile.h>
 
 TcpConnection::TcpConnection(EventLoop * loop, const std::string & name, int sockfd, const InetAddress & localAddr, const InetAddress & peerAddr)
     : loop_(loop)
@@ -13,8 +14,11 @@ TcpConnection::TcpConnection(EventLoop * loop, const std::string & name, int soc
     , peerAddr_(peerAddr)
     , state_(kConnecting)
     , reading_(false)
+    , edgeTriggered_(false)
     , socket_(new Socket(sockfd))
-    , channel_(new Channel(loop_, sockfd)) {
+    , channel_(new Channel(loop_, sockfd))
+    , idleTimeout_(0.0)
+    , idleEntry_(nullptr) {
     
     // 只有在将this暴露给外部对象的时候，才可以使用shared_from_this()，否则，对象将永生不灭
     channel_->setReadCallback(std::bind(&TcpConnection::handleRead, this, std::placeholders::_1));
@@ -64,6 +68,11 @@ bool TcpConnection::disconnected() const {
     return state_ == kDisconnected;
 }
 
+size_t TcpConnection::outputSize() const {
+    loop_->assertInLoopThread();
+    return outputBuffer_.readableSize();
+}
+
 void TcpConnection::send(const void * message, size_t size) {
     if(state_ != kConnected) {
         LOG(WARNING) << "Ignore TcpConnection::send(), state = " << stateString(state_);
@@ -71,7 +80,7 @@ void TcpConnection::send(const void * message, size_t size) {
     }
 
     if(loop_->isInLoopThread()) {
-        sendInLoop(message, size);
+        sendInLoop(message, size, nullptr);
     } else {
         std::shared_ptr<Buffer> buf = std::make_shared<Buffer>(size);
         buf->write(static_cast<const char *>(message), size);
@@ -88,6 +97,31 @@ void TcpConnection::send(BufferPtr message) {
     message->hasRead(readableSize);
 }
 
+void TcpConnection::send(const void * message, size_t size, std::shared_ptr<const void> holder) {
+    if(state_ != kConnected) {
+        LOG(WARNING) << "Ignore TcpConnection::send(), state = " << stateString(state_);
+        return ;
+    }
+
+    if(loop_->isInLoopThread()) {
+        sendInLoop(message, size, std::move(holder));
+    } else {
+        // holder保证了message的有效性，跨线程时也不需要拷贝
+        void (TcpConnection::*fp)(const void *, size_t, std::shared_ptr<const void>) = &TcpConnection::sendInLoop;
+        loop_->queueInLoop(std::bind(fp, shared_from_this(), message, size, std::move(holder)));
+    }
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t size, std::shared_ptr<const void> holder) {
+    if(state_ != kConnected) {
+        LOG(WARNING) << "Ignore TcpConnection::sendFile(), state = " << stateString(state_);
+        return ;
+    }
+
+    // FIXME this or shared_from_this()?
+    loop_->runInLoop(std::bind(&TcpConnection::sendFileInLoop, shared_from_this(), fd, offset, size, std::move(holder)));
+}
+
 void TcpConnection::shutdown() {
     if(state_ != kConnected) {
         LOG(WARNING) << "Ignore TcpConnection::shutdown(), state = " << stateString(state_);
@@ -124,6 +158,16 @@ bool TcpConnection::isReading() const {
     return reading_;
 }
 
+void TcpConnection::setEdgeTriggered(bool enabled) {
+    assert(state_ == kConnecting);
+    edgeTriggered_ = enabled;
+}
+
+void TcpConnection::setIdleTimeout(double seconds) {
+    assert(state_ == kConnecting);
+    idleTimeout_ = seconds;
+}
+
 void TcpConnection::setConnectionCallback(ConnectionCallback callback) {
     connectionCallback_ = callback;
 }
@@ -144,9 +188,19 @@ void TcpConnection::connectEstablished() {
     loop_->assertInLoopThread();
     assert(state_ == kConnecting);
     // FIXME 这里脱离了reading_的掌控
+    channel_->setEdgeTriggered(edgeTriggered_);
     channel_->enableReading();
+    if(edgeTriggered_) {
+        // 边缘触发时一直关注可写事件，只有从不可写变为可写时才会触发
+        channel_->enableWriting();
+    }
     state_ = kConnected;
 
+    if(idleTimeout_ > 0.0) {
+        std::weak_ptr<TcpConnection> weakConn(shared_from_this());
+        idleEntry_ = loop_->timingWheel()->add(idleTimeout_, std::bind(&TcpConnection::handleIdleTimeout, weakConn));
+    }
+
     connectionCallback_(shared_from_this());
 }
 
@@ -160,6 +214,7 @@ void TcpConnection::connectDestroyed() {
             connectionCallback_(shared_from_this());
         }
     }
+    removeIdleEntry();
     channel_->remove();
 }
 
@@ -174,32 +229,88 @@ boost::any & TcpConnection::getContext() {
 void TcpConnection::handleRead(TimeStamp receiveTime) {
     loop_->assertInLoopThread();
 
-    Buffer::size_type nBytes = inputBuffer_.writeFromFd(socket_->fd());
-    if(nBytes > 0) {
-        // 读到nBytes字节数据
+    Buffer::size_type total = 0;
+    Buffer::size_type nBytes = 0;
+    int savedErrno = 0;     // 消息回调可能会修改errno，须提前保存
+    // 边缘触发时一直读到EAGAIN、对端关闭或达到本次事件的上限
+    do {
+        nBytes = inputBuffer_.writeFromFd(socket_->fd());
+        if(nBytes > 0) {
+            total += nBytes;
+        } else if(nBytes < 0) {
+            savedErrno = errno;
+            if(savedErrno == EINTR) {
+                nBytes = 1;
+            }
+        }
+    } while(edgeTriggered_ && nBytes > 0 && total < kMaxReadSizePerEvent);
+    // 达到上限时socket中可能还有数据，边缘触发不会再次通知，须自行安排继续读取
+    bool readLimited = edgeTriggered_ && nBytes > 0;
+
+    if(total > 0) {
+        if(idleEntry_ != nullptr) {
+            loop_->timingWheel()->touch(idleEntry_);
+        }
+        // 读到total字节数据
         if(messageCallback_) {
             messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
         }
-    } else if(nBytes == 0) {
-        // 对端关闭连接
+        // 消息处理完后收缩接收缓冲，空闲的keep-alive连接不再占用缓冲内存
+        inputBuffer_.shrink();
+    }
+
+    if(nBytes == 0) {
+        // 对端关闭连接（消息回调中可能已经关闭了连接）
         DLOG(INFO) << "The peer (" << peerAddr_ << ") closed the tcp connection";
-        handleClose();
-    } else {
+        if(state_ == kConnected || state_ == kDisconnecting) {
+            handleClose();
+        }
+    } else if(nBytes < 0 && savedErrno != EAGAIN && savedErrno != EWOULDBLOCK) {
         // 出错
+        errno = savedErrno;
         handleError();
+    } else if(readLimited) {
+        // 排在本轮其他连接的事件之后
+        loop_->queueInLoop(std::bind(&TcpConnection::continueReadInLoop, shared_from_this()));
+    }
+}
+
+void TcpConnection::continueReadInLoop() {
+    loop_->assertInLoopThread();
+
+    // 期间连接可能已经关闭或暂停了读取（恢复读取时重新注册事件，边缘触发也会再次通知）
+    if((state_ == kConnected || state_ == kDisconnecting) && channel_->isReading()) {
+        handleRead(TimeStamp::now());
     }
 }
 
 void TcpConnection::handleWrite() {
     loop_->assertInLoopThread();
-    assert(channel_->isWriting());
 
-    Buffer::size_type nBytes = outputBuffer_.readIntoFd(socket_->fd());
-    if(nBytes >= 0) {
+    if(!channel_->isWriting() || outputBuffer_.readableSize() == 0) {
+        // 同一次事件中读回调可能已经关闭了连接；边缘触发时没有数据需要发送也会收到可写事件
+        return ;
+    }
+
+    Buffer::size_type nBytes = 0;
+    // 边缘触发时一直写到缓冲区为空或EAGAIN
+    do {
+        nBytes = outputBuffer_.readIntoFd(socket_->fd());
+        if(nBytes < 0 && errno == EINTR) {
+            nBytes = 0;
+        }
+    } while(edgeTriggered_ && nBytes >= 0 && outputBuffer_.readableSize() > 0);
+
+    if(nBytes >= 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+        if(idleEntry_ != nullptr) {
+            loop_->timingWheel()->touch(idleEntry_);
+        }
         // 写入nBytes字节
         if(outputBuffer_.readableSize() == 0) {
-            // 缓冲区全部输出
-            channel_->disableWriting();
+            // 缓冲区全部输出（边缘触发时继续关注可写事件）
+            if(!edgeTriggered_) {
+                channel_->disableWriting();
+            }
             if(writeCompleteCallback_) {
                 writeCompleteCallback_(shared_from_this());
             }
@@ -222,6 +333,7 @@ void TcpConnection::handleClose() {
 
     state_ = kDisconnected;
     channel_->disableAll();
+    removeIdleEntry();
     if(connectionCallback_) {
         connectionCallback_(shared_from_this());
     }
@@ -239,35 +351,63 @@ void TcpConnection::handleError() {
                << ", peeraddr = " << peerAddr_ << "]";
 }
 
-void TcpConnection::sendInLoop(const void * message, size_t size) {
+void TcpConnection::handleIdleTimeout(std::weak_ptr<TcpConnection> weakConn) {
+    TcpConnectionPtr conn = weakConn.lock();
+    if(conn && conn->connected()) {
+        DLOG(INFO) << "TcpConnection " << conn->name() << " has been idle for " << conn->idleTimeout_ << " seconds, closing it";
+        conn->forceClose();
+    } else if(conn && conn->state_ == kDisconnecting) {
+        // shutdown()之后对端一直不读，剩余数据永远发送不完，半关闭永远不会发生，直接关闭连接
+        DLOG(INFO) << "TcpConnection " << conn->name() << " is still disconnecting after " << conn->idleTimeout_ << " idle seconds, closing it";
+        conn->handleClose();
+    }
+}
+
+void TcpConnection::removeIdleEntry() {
+    if(idleEntry_ != nullptr) {
+        loop_->timingWheel()->remove(idleEntry_);
+        idleEntry_ = nullptr;
+    }
+}
+
+void TcpConnection::sendInLoop(const void * message, size_t size, std::shared_ptr<const void> holder) {
     loop_->assertInLoopThread();
     assert(state_ == kConnected);
 
     ssize_t remaining = size;
     ssize_t nBytes = 0;
     bool error = false;
-    // 首先尝试直接发送
-    if(!channel_->isWriting() && outputBuffer_.readableSize() == 0) {
+    // 首先尝试直接发送（边缘触发时一直关注可写事件，只看缓冲区是否为空）
+    if((edgeTriggered_ || !channel_->isWriting()) && outputBuffer_.readableSize() == 0) {
         nBytes = ::send(socket_->fd(), message, size, 0);
+        if(nBytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 发送缓冲区已满，全部缓冲发送
+            nBytes = 0;
+        }
         if(nBytes == remaining) {
-            // 全部直接发送完成
+            // 全部直接发送完成（写完成回调中可能继续发送，放到本轮事件处理之后调用，避免递归）
             remaining -= nBytes;
             if(writeCompleteCallback_) {
-                writeCompleteCallback_(shared_from_this());
+                loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
             }
         } else if(nBytes >= 0) {
             // 部分直接发送完成
             remaining -= nBytes;
         } else {
             error = true;
-            LOG(ERROR) << "Something wrong when call bind() in TcpConnection::sendInLoop(const void * message, size_t size), the errno is " << errno << "(" << strerror(errno) << ")";
+            LOG(ERROR) << "Something wrong when call send() in TcpConnection::sendInLoop(), the errno is " << errno << "(" << strerror(errno) << ")";
             handleError();
         }
     }
 
-    // 然后尝试缓冲发送
+    // 然后尝试缓冲发送（有holder时只引用剩余数据，不拷贝）
     if(!error && remaining > 0) {
-        outputBuffer_.write(static_cast<const char *>(message) + nBytes, remaining);
+        const char * rest = static_cast<const char *>(message) + nBytes;
+        if(holder) {
+            outputBuffer_.append(std::move(holder), rest, remaining);
+        } else {
+            outputBuffer_.append(rest, remaining);
+        }
         if(!channel_->isWriting()) {
             channel_->enableWriting();
         }
@@ -277,7 +417,44 @@ void TcpConnection::sendInLoop(const void * message, size_t size) {
 
 void TcpConnection::sendInLoop(std::shared_ptr<Buffer> message) {
     loop_->assertInLoopThread();
-    sendInLoop(message->readBegin(), message->readableSize());
+    // message由bind持有，缓冲发送时可以直接引用
+    sendInLoop(message->readBegin(), message->readableSize(), message);
+}
+
+void TcpConnection::sendFileInLoop(int fd, off_t offset, size_t size, std::shared_ptr<const void> holder) {
+    loop_->assertInLoopThread();
+    if(state_ != kConnected) {
+        // 跨线程调用时连接可能已经关闭
+        return ;
+    }
+
+    ssize_t remaining = size;
+    ssize_t nBytes = 0;
+    // 首先尝试直接发送
+    if((edgeTriggered_ || !channel_->isWriting()) && outputBuffer_.readableSize() == 0) {
+        nBytes = ::sendfile(socket_->fd(), fd, &offset, size);
+        if(nBytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 发送缓冲区已满，全部缓冲发送
+            nBytes = 0;
+        } else if(nBytes < 0) {
+            LOG(ERROR) << "Something wrong when call sendfile() in TcpConnection::sendFileInLoop(), the errno is " << errno << "(" << strerror(errno) << ")";
+            handleClose();
+            return ;
+        }
+        // sendfile()已经将offset推进了nBytes
+        remaining -= nBytes;
+        if(remaining == 0 && writeCompleteCallback_) {
+            loop_->queueInLoop(std::bind(writeCompleteCallback_, shared_from_this()));
+        }
+    }
+
+    // 然后尝试缓冲发送
+    if(remaining > 0) {
+        outputBuffer_.appendFile(std::move(holder), fd, offset, remaining);
+        if(!channel_->isWriting()) {
+            channel_->enableWriting();
+        }
+    }
 }
 
 void TcpConnection::shutdownInLoop() {
@@ -285,7 +462,7 @@ void TcpConnection::shutdownInLoop() {
     assert(state_ == kDisconnecting);
     
     // 没数据需要发送了才会执行
-    if(!channel_->isWriting()) {
+    if(outputBuffer_.readableSize() == 0) {
         socket_->shutdownWrite();
     }
     // 若还有数据需要发送，则待数据发送完毕后，会自动再次调用shutdownInLoop()
@@ -3,6 +3,7 @@
 #include "EventLoopThreadPool.h"
 #include "TcpConnection.h"
 #include "EventLoop.h"
+#include "CountDownLatch.h"
 #include <cassert>
 #include <glog/logging.h>
 
@@ -10,14 +11,34 @@ TcpServer::TcpServer(EventLoop * loop, const InetAddress & localAddr, const std:
     : loop_(loop)
     , localAddr_(localAddr)
     , name_(name)
-    , acceptor_(new Acceptor(loop, localAddr_))
+    , acceptor_()
     , threadPool_(new EventLoopThreadPool(loop, name_))
+    , loopAcceptors_()
     , started_(false)
-    , nextConnId_(0) {
-    acceptor_->setNewConnectionCallback(std::bind(&TcpServer::handleNewConnection, this, std::placeholders::_1, std::placeholders::_2));
+    , nextConnId_(0)
+    , idleTimeout_(0.0)
+    , edgeTriggered_(false)
+    , reusePort_(false)
+    , acceptBatchSize_(kDefaultAcceptBatchSize)
+    , mutex_()
+    , connections_() {
 }
 
 TcpServer::~TcpServer() {
+    // IO线程的Acceptor必须在其所属的IO线程中关闭和析构
+    // 其新连接回调绑定了this，须等待全部关闭后才能继续析构，否则IO线程可能在析构之后接收新连接
+    if(!loopAcceptors_.empty()) {
+        CountDownLatch latch(static_cast<int>(loopAcceptors_.size()));
+        for(auto & acceptor : loopAcceptors_) {
+            std::shared_ptr<Acceptor> holder;
+            holder.swap(acceptor);
+            EventLoop * ioLoop = holder->getLoop();
+            ioLoop->runInLoop(std::bind(&TcpServer::closeInLoop, holder, &latch));
+        }
+        latch.wait();
+    }
+
+    MutexLockGuard lock(mutex_);
     for(auto & item : connections_) {
         auto conn = item.second;
         item.second.reset();
@@ -41,12 +62,50 @@ void TcpServer::setThreadNum(int numThreads) {
     threadPool_->setThreadNum(numThreads);
 }
 
+void TcpServer::setIdleTimeout(double seconds) {
+    idleTimeout_ = seconds;
+}
+
+void TcpServer::setEdgeTriggered(bool enabled) {
+    assert(!started_);
+    edgeTriggered_ = enabled;
+}
+
+void TcpServer::setAcceptBatchSize(int batchSize) {
+    assert(!started_);
+    acceptBatchSize_ = batchSize;
+}
+
+void TcpServer::setReusePort(bool enabled) {
+    assert(!started_);
+    reusePort_ = enabled;
+}
+
 void TcpServer::start() {
     assert(!started_);
-    assert(!acceptor_->listenning());
 
     threadPool_->start(threadInitCallback_);
-    acceptor_->listen();
+    if(reusePort_) {
+        // 每个IO线程创建自己的监听socket并在本线程中accept
+        std::vector<EventLoop *> ioLoops(threadPool_->getAllLoops());
+        CountDownLatch latch(static_cast<int>(ioLoops.size()));
+        for(EventLoop * ioLoop : ioLoops) {
+            std::shared_ptr<Acceptor> acceptor(std::make_shared<Acceptor>(ioLoop, localAddr_));
+            acceptor->setNewConnectionCallback(std::bind(&TcpServer::newConnection, this, ioLoop, std::placeholders::_1, std::placeholders::_2));
+            acceptor->setEdgeTriggered(edgeTriggered_);
+            acceptor->setAcceptBatchSize(acceptBatchSize_);
+            ioLoop->runInLoop(std::bind(&TcpServer::listenInLoop, acceptor, &latch));
+            loopAcceptors_.push_back(acceptor);
+        }
+        // 等待所有IO线程开始监听，保证start()返回后即可接受连接
+        latch.wait();
+    } else {
+        acceptor_.reset(new Acceptor(loop_, localAddr_));
+        acceptor_->setNewConnectionCallback(std::bind(&TcpServer::handleNewConnection, this, std::placeholders::_1, std::placeholders::_2));
+        acceptor_->setEdgeTriggered(edgeTriggered_);
+        acceptor_->setAcceptBatchSize(acceptBatchSize_);
+        acceptor_->listen();
+    }
     started_ = true;
 }
 
@@ -66,17 +125,42 @@ void TcpServer::setWriteCompleteCallback(WriteCompleteCallback callback) {
     writeCompleteCallback_ = callback;
 }
 
+void TcpServer::listenInLoop(std::shared_ptr<Acceptor> acceptor, CountDownLatch * latch) {
+    acceptor->listen();
+    latch->countDown();
+}
+
+void TcpServer::closeInLoop(std::shared_ptr<Acceptor> acceptor, CountDownLatch * latch) {
+    acceptor->close();
+    latch->countDown();
+}
+
 void TcpServer::handleNewConnection(int sockfd, const InetAddress & peerAddr) {
-    std::string connName = name_ + "#" + std::to_string(nextConnId_) + " [" + static_cast<std::string>(peerAddr) + "]";
-    TcpConnectionPtr conn = std::make_shared<TcpConnection>(threadPool_->getNextLoop(), connName, sockfd, localAddr_, peerAddr);
-    ++nextConnId_;
+    loop_->assertInLoopThread();
+    newConnection(threadPool_->getNextLoop(), sockfd, peerAddr);
+}
+
+void TcpServer::newConnection(EventLoop * ioLoop, int sockfd, const InetAddress & peerAddr) {
+    int connId = 0;
+    {
+        MutexLockGuard lock(mutex_);
+        connId = nextConnId_++;
+    }
+
+    std::string connName = name_ + "#" + std::to_string(connId) + " [" + static_cast<std::string>(peerAddr) + "]";
+    TcpConnectionPtr conn = std::make_shared<TcpConnection>(ioLoop, connName, sockfd, localAddr_, peerAddr);
 
-    connections_.insert({conn->hashCode(), conn});
+    {
+        MutexLockGuard lock(mutex_);
+        connections_.insert({conn->hashCode(), conn});
+    }
 
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
     conn->setWriteCompleteCallback(writeCompleteCallback_);
-    conn->setCloseCallback(std::bind(&TcpServer::handleRemoveConnection, this, conn));
+    conn->setCloseCallback(std::bind(&TcpServer::handleRemoveConnection, this, std::placeholders::_1));
+    conn->setIdleTimeout(idleTimeout_);
+    conn->setEdgeTriggered(edgeTriggered_);
     conn->getLoop()->runInLoop(std::bind(&TcpConnection::connectEstablished, conn));
 
     DLOG(INFO) << "New connection [name = " << conn->name()
@@ -86,14 +170,21 @@ void TcpServer::handleNewConnection(int sockfd, const InetAddress & peerAddr) {
 }
 
 void TcpServer::handleRemoveConnection(TcpConnectionPtr conn) {
-    loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+    if(reusePort_) {
+        // 连接由IO线程自己接收，直接在IO线程中移除，不再经过主线程
+        removeConnectionInLoop(conn);
+    } else {
+        loop_->runInLoop(std::bind(&TcpServer::removeConnectionInLoop, this, conn));
+    }
 }
 
 void TcpServer::removeConnectionInLoop(TcpConnectionPtr conn) {
-    loop_->assertInLoopThread();
-
-    connections_.erase(conn->hashCode());
-    conn->getLoop()->runInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
+    {
+        MutexLockGuard lock(mutex_);
+        connections_.erase(conn->hashCode());
+    }
+    // 此时可能还处于conn的事件处理过程中，推迟到本轮事件处理完毕后再销毁
+    conn->getLoop()->queueInLoop(std::bind(&TcpConnection::connectDestroyed, conn));
 
     DLOG(INFO) << "Connection removed [name = " << conn->name()
                << ", localaddr = " << conn->localAddress()
@@ -0,0 +1,44 @@
+#include "Timer.h"
+
+Timer::Timer(TimerCallback callback, TimeStamp expiration, double interval)
+    : callback_(std::move(callback))
+    , expiration_(expiration)
+    , interval_(interval)
+    , repeat_(interval > 0.0)
+    , sequence_(++numCreated_) {
+}
+
+Timer::~Timer() {
+}
+
+void Timer::run() const {
+    if(callback_) {
+        callback_();
+    }
+}
+
+TimeStamp Timer::expiration() const {
+    return expiration_;
+}
+
+bool Timer::repeat() const {
+    return repeat_;
+}
+
+int64_t Timer::sequence() const {
+    return sequence_;
+}
+
+void Timer::restart(TimeStamp now) {
+    if(repeat_) {
+        expiration_ = TimeStamp(now.microseconds() + static_cast<int64_t>(interval_ * TimeStamp::kMicroSecondsPerSecond));
+    } else {
+        expiration_ = TimeStamp();
+    }
+}
+
+int64_t Timer::numCreated() {
+    return numCreated_.load();
+}
+
+std::atomic<int64_t> Timer::numCreated_(0);
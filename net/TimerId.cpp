@@ -0,0 +1,18 @@
+#include "TimerId.h"
+
+TimerId::TimerId()
+    : timer_(nullptr)
+    , sequence_(0) {
+}
+
+TimerId::TimerId(Timer * timer, int64_t sequence)
+    : timer_(timer)
+    , sequence_(sequence) {
+}
+
+TimerId::~TimerId() {
+}
+
+bool TimerId::valid() const {
+    return timer_ != nullptr;
+}
@@ -0,0 +1,164 @@
+#include "TimerQueue.h"
+#include "Timer.h"
+#include "Channel.h"
+#include "EventLoop.h"
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <glog/logging.h>
+#include <cassert>
+#include <cstring>
+#include <errno.h>
+
+TimerQueue::TimerQueue(EventLoop * loop)
+    : loop_(loop)
+    , timerFd_(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+    , timerChannel_(new Channel(loop, timerFd_))
+    , timers_()
+    , activeTimers_()
+    , callingExpiredTimers_(false)
+    , cancelingTimers_() {
+    if(timerFd_ == -1) {
+        LOG(FATAL) << "Something wrong when call timerfd_create(), the errno is " << errno << "(" << strerror(errno) << ")";
+    }
+
+    timerChannel_->setReadCallback(std::bind(&TimerQueue::handleRead, this));
+    timerChannel_->enableReading();
+}
+
+TimerQueue::~TimerQueue() {
+    timerChannel_->disableAll();
+    timerChannel_->remove();
+    ::close(timerFd_);
+
+    // timers_和activeTimers_中保存的是同一批定时器，只需释放一次
+    for(const Entry & timer : timers_) {
+        delete timer.second;
+    }
+}
+
+TimerId TimerQueue::addTimer(TimerCallback callback, TimeStamp when, double interval) {
+    Timer * timer = new Timer(std::move(callback), when, interval);
+    loop_->runInLoop(std::bind(&TimerQueue::addTimerInLoop, this, timer));
+    return TimerId(timer, timer->sequence());
+}
+
+void TimerQueue::cancel(TimerId timerId) {
+    loop_->runInLoop(std::bind(&TimerQueue::cancelInLoop, this, timerId));
+}
+
+void TimerQueue::addTimerInLoop(Timer * timer) {
+    loop_->assertInLoopThread();
+
+    bool earliestChanged = insert(timer);
+    if(earliestChanged) {
+        resetTimerFd(timer->expiration());
+    }
+}
+
+void TimerQueue::cancelInLoop(TimerId timerId) {
+    loop_->assertInLoopThread();
+    assert(timers_.size() == activeTimers_.size());
+
+    ActiveTimer timer(timerId.timer_, timerId.sequence_);
+    auto it = activeTimers_.find(timer);
+    if(it != activeTimers_.end()) {
+        size_t n = timers_.erase(Entry(it->first->expiration(), it->first));
+        assert(n == 1);
+        delete it->first;
+        activeTimers_.erase(it);
+    } else if(callingExpiredTimers_) {
+        // 定时器正在执行（例如在定时器任务中取消自己），待执行完毕后不再重新插入
+        cancelingTimers_.insert(timer);
+    }
+
+    assert(timers_.size() == activeTimers_.size());
+}
+
+void TimerQueue::handleRead() {
+    loop_->assertInLoopThread();
+
+    uint64_t howmany;
+    ssize_t nBytes = ::read(timerFd_, &howmany, sizeof(howmany));
+    if(nBytes != sizeof(howmany)) {
+        LOG(ERROR) << "TimerQueue::handleRead() reads " << nBytes << " bytes instead of " << sizeof(howmany);
+    }
+
+    TimeStamp now(TimeStamp::now());
+    std::vector<Entry> expired = getExpired(now);
+
+    callingExpiredTimers_ = true;
+    cancelingTimers_.clear();
+    for(const Entry & entry : expired) {
+        entry.second->run();
+    }
+    callingExpiredTimers_ = false;
+
+    reset(expired, now);
+}
+
+std::vector<TimerQueue::Entry> TimerQueue::getExpired(TimeStamp now) {
+    assert(timers_.size() == activeTimers_.size());
+
+    // 找到第一个未到期的定时器
+    Entry sentry(now, reinterpret_cast<Timer *>(UINTPTR_MAX));
+    auto end = timers_.lower_bound(sentry);
+    assert(end == timers_.end() || now < end->first);
+
+    std::vector<Entry> expired(timers_.begin(), end);
+    timers_.erase(timers_.begin(), end);
+
+    for(const Entry & entry : expired) {
+        size_t n = activeTimers_.erase(ActiveTimer(entry.second, entry.second->sequence()));
+        assert(n == 1);
+    }
+
+    assert(timers_.size() == activeTimers_.size());
+    return expired;
+}
+
+void TimerQueue::reset(const std::vector<Entry> & expired, TimeStamp now) {
+    for(const Entry & entry : expired) {
+        ActiveTimer timer(entry.second, entry.second->sequence());
+        if(entry.second->repeat() && cancelingTimers_.find(timer) == cancelingTimers_.end()) {
+            entry.second->restart(now);
+            insert(entry.second);
+        } else {
+            delete entry.second;
+        }
+    }
+
+    if(!timers_.empty()) {
+        resetTimerFd(timers_.begin()->second->expiration());
+    }
+}
+
+bool TimerQueue::insert(Timer * timer) {
+    loop_->assertInLoopThread();
+    assert(timers_.size() == activeTimers_.size());
+
+    TimeStamp when = timer->expiration();
+    bool earliestChanged = timers_.empty() || when < timers_.begin()->first;
+
+    timers_.insert(Entry(when, timer));
+    activeTimers_.insert(ActiveTimer(timer, timer->sequence()));
+
+    assert(timers_.size() == activeTimers_.size());
+    return earliestChanged;
+}
+
+void TimerQueue::resetTimerFd(TimeStamp expiration) {
+    // timerfd不接受0或负的超时时间，至少设置为100微秒
+    int64_t microseconds = expiration.microseconds() - TimeStamp::now().microseconds();
+    if(microseconds < 100) {
+        microseconds = 100;
+    }
+
+    struct itimerspec newValue;
+    memset(&newValue, 0, sizeof(newValue));
+    newValue.it_value.tv_sec = static_cast<time_t>(microseconds / TimeStamp::kMicroSecondsPerSecond);
+    newValue.it_value.tv_nsec = static_cast<long>((microseconds % TimeStamp::kMicroSecondsPerSecond) * 1000);
+
+    if(::timerfd_settime(timerFd_, 0, &newValue, nullptr) == -1) {
+        LOG(FATAL) << "Something wrong when call timerfd_settime(), the errno is " << errno << "(" << strerror(errno) << ")";
+    }
+}
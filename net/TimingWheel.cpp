@@ -0,0 +1,162 @@
+#include "TimingWheel.h"
+#include "EventLoop.h"
+#include <cassert>
+#include <cmath>
+
+struct TimingWheel::Entry {
+    TimeoutCallback callback;   // 超时回调函数
+    int64_t ticks;              // 超时时间对应的格数
+    int64_t rounds;             // 剩余圈数
+    size_t bucket;              // 所在的格子，kNoBucket表示不在时间轮中
+    bool removed;               // 是否已被remove()（延迟到超时回调全部执行完毕后再释放）
+    EntryPtr prev;
+    EntryPtr next;
+
+    static constexpr size_t kNoBucket = static_cast<size_t>(-1);
+};
+
+TimingWheel::TimingWheel(EventLoop * loop, int numBuckets, double tick)
+    : loop_(loop)
+    , tick_(tick)
+    , buckets_(numBuckets, nullptr)
+    , cursor_(0)
+    , size_(0)
+    , ticking_(false)
+    , tickTimer_()
+    , callingCallbacks_(false)
+    , removedEntries_() {
+    assert(numBuckets > 0);
+    assert(tick > 0.0);
+}
+
+TimingWheel::~TimingWheel() {
+    if(ticking_) {
+        loop_->cancel(tickTimer_);
+    }
+
+    for(EntryPtr head : buckets_) {
+        while(head != nullptr) {
+            EntryPtr next = head->next;
+            delete head;
+            head = next;
+        }
+    }
+}
+
+TimingWheel::EntryPtr TimingWheel::add(double timeout, TimeoutCallback callback) {
+    loop_->assertInLoopThread();
+
+    EntryPtr entry = new Entry;
+    entry->callback = std::move(callback);
+    entry->ticks = std::max(static_cast<int64_t>(std::ceil(timeout / tick_)), static_cast<int64_t>(1));
+    entry->rounds = 0;
+    entry->bucket = Entry::kNoBucket;
+    entry->removed = false;
+    entry->prev = nullptr;
+    entry->next = nullptr;
+    link(entry);
+
+    // 第一次使用时才启动tick定时器，没有使用时间轮的EventLoop不会被周期性唤醒
+    if(!ticking_) {
+        ticking_ = true;
+        tickTimer_ = loop_->runEvery(tick_, std::bind(&TimingWheel::handleTick, this));
+    }
+
+    return entry;
+}
+
+void TimingWheel::touch(EntryPtr entry) {
+    loop_->assertInLoopThread();
+
+    unlink(entry);
+    link(entry);
+}
+
+void TimingWheel::remove(EntryPtr entry) {
+    loop_->assertInLoopThread();
+
+    unlink(entry);
+    if(callingCallbacks_) {
+        // 正在执行超时回调，entry可能还在超时列表中，延迟释放
+        entry->removed = true;
+        removedEntries_.push_back(entry);
+    } else {
+        delete entry;
+    }
+}
+
+size_t TimingWheel::size() const {
+    return size_;
+}
+
+void TimingWheel::handleTick() {
+    loop_->assertInLoopThread();
+
+    cursor_ = (cursor_ + 1) % buckets_.size();
+
+    // 先摘下所有超时的条目再调用回调函数，回调函数中可以安全地touch()或remove()任意条目
+    std::vector<EntryPtr> expired;
+    EntryPtr entry = buckets_[cursor_];
+    while(entry != nullptr) {
+        EntryPtr next = entry->next;
+        if(entry->rounds > 0) {
+            --entry->rounds;
+        } else {
+            unlink(entry);
+            expired.push_back(entry);
+        }
+        entry = next;
+    }
+
+    callingCallbacks_ = true;
+    for(EntryPtr timeout : expired) {
+        // 超时的条目仍由调用者持有，跳过在前面的回调中被touch()或remove()的条目
+        if(timeout->bucket == Entry::kNoBucket && !timeout->removed && timeout->callback) {
+            timeout->callback();
+        }
+    }
+    callingCallbacks_ = false;
+
+    for(EntryPtr entry : removedEntries_) {
+        delete entry;
+    }
+    removedEntries_.clear();
+}
+
+void TimingWheel::link(EntryPtr entry) {
+    assert(entry->bucket == Entry::kNoBucket);
+
+    // 超时时间为ticks格，第ticks次tick到达该格子时超时
+    size_t numBuckets = buckets_.size();
+    entry->bucket = (cursor_ + entry->ticks) % numBuckets;
+    entry->rounds = (entry->ticks - 1) / numBuckets;
+
+    EntryPtr & head = buckets_[entry->bucket];
+    entry->prev = nullptr;
+    entry->next = head;
+    if(head != nullptr) {
+        head->prev = entry;
+    }
+    head = entry;
+    ++size_;
+}
+
+void TimingWheel::unlink(EntryPtr entry) {
+    if(entry->bucket == Entry::kNoBucket) {
+        return ;
+    }
+
+    if(entry->prev != nullptr) {
+        entry->prev->next = entry->next;
+    } else {
+        buckets_[entry->bucket] = entry->next;
+    }
+    if(entry->next != nullptr) {
+        entry->next->prev = entry->prev;
+    }
+
+    entry->prev = nullptr;
+    entry->next = nullptr;
+    entry->bucket = Entry::kNoBucket;
+    --size_;
+}
@@ -4,6 +4,8 @@
 #include <boost/utility.hpp>
 #include <memory>
 #include <functional>
+#include <cstdint>
+#include "TimerId.h"
 
 class EventLoop;
 class Channel;
@@ -17,22 +19,64 @@ public:
     Acceptor(EventLoop * loop, const InetAddress & localAddr);
     ~Acceptor();
 
+    // 获取所属的EventLoop
+    EventLoop * getLoop() const;
     // 设置新连接回调函数
     void setNewConnectionCallback(NewConnectionCallback callback);
+    // 设置是否使用边缘触发，须在listen()之前调用
+    void setEdgeTriggered(bool enabled);
+    // 设置每次可读事件最多accept的连接数（边缘触发时总是accept到EAGAIN，出错时最多容忍该数量的错误）
+    void setAcceptBatchSize(int batchSize);
+    // 设置输出accept统计信息的间隔（秒），小于等于0表示不输出，须在listen()之前调用
+    void setStatsInterval(double seconds);
     // 开始监听
     void listen();
     // 监听
     bool listenning() const;
+    // 停止监听（在所属的IO线程中调用）
+    void close();
+
+    // 已接收的连接数
+    uint64_t acceptedCount() const;
+    // 因文件描述符耗尽而丢弃的连接数
+    uint64_t droppedCount() const;
+    // 可读事件（唤醒）次数
+    uint64_t wakeupCount() const;
 
 private:
     void handleRead();
+    // accept队列中的连接，边缘触发时直到EAGAIN或出错过多
+    void acceptConnections();
+    // 边缘触发时不会再有可读事件，须通过定时器稍后重试accept
+    void scheduleRetry();
+    void handleRetry();
+    // 文件描述符耗尽时，借用预留的fd接收并立即关闭连接，避免监听socket一直可读，成功丢弃返回true
+    bool dropConnection();
+    // 输出accept统计信息
+    void reportStats();
 
     EventLoop * loop_;
     std::unique_ptr<Socket> socket_;
     std::unique_ptr<Channel> channel_;
     bool listenning_;
+    bool edgeTriggered_;
+    int acceptBatchSize_;
+    int idleFd_;                    // 预留的文件描述符
+
+    uint64_t acceptedCount_;
+    uint64_t droppedCount_;
+    uint64_t wakeupCount_;
+    uint64_t lastAcceptedCount_;    // 上次输出统计信息时的acceptedCount_
+    uint64_t lastWakeupCount_;      // 上次输出统计信息时的wakeupCount_
+    double statsInterval_;
+    TimerId statsTimer_;
+    TimerId retryTimer_;            // 边缘触发时重试accept的定时器
 
     NewConnectionCallback newConnectionCallback_;
+
+    static constexpr int kDefaultAcceptBatchSize = 16;
+    static constexpr double kDefaultStatsInterval = 60.0;
+    static constexpr double kRetryDelay = 0.1;         // 边缘触发时重试accept的延迟（秒）
 };
 
 #endif //__ACCEPTOR_H__
@@ -2,8 +2,10 @@
 #define __BUFFER_H__
 
 #include <boost/noncopyable.hpp>
-#include <vector>
+#include <sys/types.h>
+#include "BufferPool.h"
 
+// 内存在第一次写入时才分配，默认大小的内存从当前线程的BufferPool中分配
 class Buffer: public boost::noncopyable {
 public:
     using size_type = ssize_t;
@@ -13,6 +15,8 @@ public:
 
     size_type readableSize();
     size_type writableSize();
+    // 已分配的内存大小
+    size_type capacity() const;
 
     char * readBegin();
     char * writeBegin();
@@ -26,14 +30,24 @@ public:
     size_type read(char * buf, size_type size);
     size_type write(const char * buf, size_type size);
     void ensure(size_type size);
+    // 收缩内存：没有未读数据时释放全部内存（默认大小的内存归还到BufferPool），
+    // 否则在内存超过kHighWaterSize时缩小到能容纳未读数据的大小
+    void shrink();
 
 private:
-
-    std::vector<char> buffer_;
+    // 分配size字节的内存
+    static char * allocate(size_type size);
+    // 释放allocate()分配的内存
+    static void deallocate(char * data, size_type size);
+
+    const size_type initialSize_;   // 第一次分配内存的大小
+    char * buffer_;
+    size_type capacity_;
     size_type readIndex_;
     size_type writeIndex_;
 
-    static constexpr size_type kBufferInitialSize = 8192;
+    static constexpr size_type kBufferInitialSize = BufferPool::kBlockSize;
+    static constexpr size_type kHighWaterSize = 65536;     // 超过该大小且有未读数据时shrink()才会缩小内存
 };
 
 #endif //__BUFFER_H__
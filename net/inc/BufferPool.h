@@ -0,0 +1,46 @@
+#ifndef __BUFFERPOOL_H__
+#define __BUFFERPOOL_H__
+
+#include <boost/utility.hpp>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// 每个线程（即每个EventLoop）一个的定长内存块池，Buffer的默认大小的内存块从这里分配和归还
+// 连接频繁建立和断开时复用内存块，避免每个连接都要malloc/free多个8KB的缓冲
+// 在其他线程中分配的内存块也可以归还到当前线程的池中，池中缓存的块数有上限，超出部分直接释放
+class BufferPool: public boost::noncopyable {
+public:
+    struct Stats {
+        uint64_t hits;          // 从池中取到内存块的次数
+        uint64_t misses;        // 池为空而新分配内存块的次数
+        size_t freeBlocks;      // 池中缓存的内存块数目
+        size_t residentBytes;   // 池中缓存的内存块占用的字节数
+
+        // 命中率
+        double hitRate() const;
+    };
+
+    // 从当前线程的池中分配一块kBlockSize字节的内存
+    static char * allocate();
+    // 将内存块归还到当前线程的池中
+    static void deallocate(char * block);
+    // 获取当前线程的池的统计信息
+    static Stats stats();
+
+    static constexpr size_t kBlockSize = 8192;          // 内存块大小
+    static constexpr size_t kMaxFreeBlocks = 1024;      // 每个池最多缓存的内存块数目（8MB）
+
+private:
+    BufferPool();
+    ~BufferPool();
+
+    // 获取当前线程的池，线程退出时池已被销毁则返回nullptr
+    static BufferPool * threadPool();
+
+    std::vector<char *> freeBlocks_;
+    uint64_t hits_;
+    uint64_t misses_;
+};
+
+#endif //__BUFFERPOOL_H__
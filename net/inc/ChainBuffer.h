@@ -0,0 +1,64 @@
+#ifndef __CHAINBUFFER_H__
+#define __CHAINBUFFER_H__
+
+#include <boost/noncopyable.hpp>
+#include <deque>
+#include <memory>
+#include <sys/types.h>
+#include "Buffer.h"
+
+// 由多个块串联而成的发送缓冲，通过writev()一次输出多个块
+// 块分为三种：
+// 1. 拷贝块：数据被拷贝到块自己持有的Buffer中，适合小块数据，相邻的小块会被合并到同一个Buffer中
+// 2. 引用块：只记录数据的地址和长度，由holder保证数据在发送完毕前有效，适合响应体等大块数据，避免拷贝和扩容
+// 3. 文件块：只记录文件描述符、偏移和长度，由holder保证文件在发送完毕前不被关闭，使用sendfile()输出，数据不经过用户空间
+class ChainBuffer: public boost::noncopyable {
+public:
+    using size_type = Buffer::size_type;
+    using Holder    = std::shared_ptr<const void>;
+
+    ChainBuffer();
+    ~ChainBuffer();
+
+    // 可读（待发送）的总字节数
+    size_type readableSize() const;
+    // 块的数量
+    size_t blockCount() const;
+
+    // 拷贝数据到缓冲尾部
+    void append(const void * data, size_type size);
+    // 引用数据到缓冲尾部，holder须保证data在发送完毕前有效，过小的数据会直接拷贝
+    void append(Holder holder, const void * data, size_type size);
+    // 引用文件fileFd中从offset开始的size字节到缓冲尾部，holder须保证fileFd在发送完毕前有效
+    void appendFile(Holder holder, int fileFd, off_t offset, size_type size);
+
+    // 将数据写入fd（头部的连续内存块使用writev()，文件块使用sendfile()），返回写入的字节数，出错返回-1
+    size_type readIntoFd(int fd);
+    // 丢弃头部size字节
+    void hasRead(size_type size);
+    // 丢弃全部数据
+    void clear();
+
+private:
+    struct Block {
+        std::unique_ptr<Buffer> buffer; // 拷贝块持有的Buffer，其他块为nullptr
+        Holder holder;                  // 引用块数据或文件块文件的持有者
+        const char * data;              // 引用块数据的起始地址
+        int fileFd;                     // 文件块的文件描述符，其他块为-1
+        off_t offset;                   // 文件块剩余数据在文件中的偏移
+        size_type size;                 // 引用块或文件块剩余的字节数
+
+        bool isFile() const;
+        const char * readBegin() const;
+        size_type readableSize() const;
+    };
+
+    std::deque<Block> blocks_;
+    size_type readableSize_;
+
+    static constexpr size_type kMinCopyBlockSize = 4096;    // 新建拷贝块的最小容量
+    static constexpr size_type kMinReferenceSize = 1024;    // 小于该长度的引用数据直接拷贝，避免iovec过碎
+    static constexpr int kMaxIovecs = 64;                   // 每次writev()最多输出的块数
+};
+
+#endif //__CHAINBUFFER_H__
@@ -51,6 +51,10 @@ public:
     bool isReading() const;
     // 查看是否使能可写事件
     bool isWriting() const;
+    // 设置是否使用边缘触发（须在第一次使能事件之前设置）
+    void setEdgeTriggered(bool enabled);
+    // 查看是否使用边缘触发
+    bool isEdgeTriggered() const;
 
     // 将channel脱离所在的loop
     void remove();
@@ -63,6 +67,7 @@ private:
     int fd_;
     int events_;
     int revents_;
+    bool edgeTriggered_;
 
     ReadEventCallback readCallback;
     EventCallback writeCallback;
@@ -72,6 +77,7 @@ private:
     static const int kNoneEvent;
     static const int kReadEvent;
     static const int kWriteEvent;
+    static const int kEdgeTriggeredEvent;
 };
 
 #endif //__CHANNEL_H__
@@ -5,10 +5,15 @@
 #include <functional>
 #include <vector>
 #include <memory>
-#include "Mutex.h"
+#include <atomic>
+#include "MpscQueue.h"
+#include "TimerId.h"
 
 class Channel;
 class Poller;
+class TimerQueue;
+class TimingWheel;
+class TimeStamp;
 
 class EventLoop: public boost::noncopyable {
 public:
@@ -16,6 +21,7 @@ public:
     using ChannelPtr    = Channel *;
     using ChannelList   = std::vector<ChannelPtr>;
     using PollerPtr     = std::unique_ptr<Poller>;
+    using TimerCallback = std::function<void(void)>;
 
     EventLoop();
     ~EventLoop();
@@ -29,7 +35,16 @@ public:
     // 将task加入到任务队列
     void queueInLoop(Functor task);
 
-    // FIXME 加入定时器任务
+    // 在time时刻执行定时器任务（线程安全）
+    TimerId runAt(TimeStamp time, TimerCallback callback);
+    // 在delay秒后执行定时器任务（线程安全）
+    TimerId runAfter(double delay, TimerCallback callback);
+    // 每隔interval秒执行一次定时器任务（线程安全）
+    TimerId runEvery(double interval, TimerCallback callback);
+    // 取消定时器任务（线程安全）
+    void cancel(TimerId timerId);
+    // 获取EventLoop持有的时间轮（用于管理连接的空闲超时）
+    TimingWheel * timingWheel();
 
     // 唤醒Poller::poll()
     void wakeup();
@@ -62,9 +77,11 @@ private:
     const pid_t threadId_;          // EventLoop所在的线程
 
     PollerPtr poller_;              // Poller
+    std::unique_ptr<TimerQueue> timerQueue_;    // 定时器队列
+    std::unique_ptr<TimingWheel> timingWheel_;  // 时间轮
 
-    mutable MutexLock mutex_;       // 用于保护任务队列
-    std::vector<Functor> pendingFunctors_;  // 任务队列
+    MpscQueue<Functor> pendingFunctors_;    // 无锁任务队列
+    std::atomic<bool> wakeupPending_;       // 是否已有未被处理的唤醒，用于合并多次唤醒
 
     static constexpr int kPollTimeMs = 10000;   // poll超时时间
 };
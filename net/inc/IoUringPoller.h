@@ -0,0 +1,79 @@
+#ifndef __IOURINGPOLLER_H__
+#define __IOURINGPOLLER_H__
+
+#include "Poller.h"
+#include <cstdint>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// IoUringPoller使用io_uring的IORING_OP_POLL_ADD检测事件
+// 一次poll()只调用一次io_uring_enter()，同时完成所有channel的注册、修改和等待，省去了epoll_ctl()的系统调用
+// 每个poll请求只触发一次，处理完事件后在下一次poll()时重新提交，因此语义与水平触发的epoll相同
+// 边缘触发的channel使用multishot poll，提交一次后持续产生事件
+class IoUringPoller: public Poller {
+public:
+    IoUringPoller(EventLoop * loop);
+    ~IoUringPoller() override;
+
+    TimeStamp poll(int timeoutMs, ChannelList & activeChannels) override;
+    void updateChannel(ChannelPtr channel) override;
+    void removeChannel(ChannelPtr channel) override;
+
+    // 当前内核是否支持IoUringPoller需要的io_uring特性（结果会被缓存）
+    static bool isSupported();
+
+private:
+    // 每个fd上poll请求的状态
+    struct PollState {
+        uint64_t userData;      // 已提交的poll请求的user_data，用于识别过期的完成事件
+        uint32_t events;        // 已提交的poll请求关注的事件
+        int revents;            // 本轮收割到的事件
+        bool armed;             // 是否有已提交且未完成的poll请求
+        bool queued;            // 是否已在pendingFds_中等待提交
+    };
+
+    // 创建并映射io_uring，成功返回true
+    bool setupRing();
+    // 获取一个空闲的sqe，队列满时先提交
+    struct io_uring_sqe * getSqe();
+    // 为channel提交poll请求
+    void armChannel(ChannelPtr channel, PollState & state);
+    // 取消fd上已提交的poll请求
+    void cancelPoll(PollState & state);
+    // 将fd加入待提交队列
+    void queueFd(int fd, PollState & state);
+    // 提交所有sqe，并等待至少waitNr个完成事件
+    int enter(unsigned waitNr, int timeoutMs);
+
+    int ringFd_;
+
+    // 提交队列
+    void * sqRing_;
+    size_t sqRingSize_;
+    unsigned * sqHead_;
+    unsigned * sqTail_;
+    unsigned * sqMask_;
+    unsigned * sqArray_;
+    unsigned sqEntries_;
+    unsigned sqLocalTail_;
+    struct io_uring_sqe * sqes_;
+
+    // 完成队列
+    void * cqRing_;
+    size_t cqRingSize_;
+    unsigned * cqHead_;
+    unsigned * cqTail_;
+    unsigned * cqMask_;
+    struct io_uring_cqe * cqes_;
+
+    uint32_t generation_;                           // 用于生成user_data
+    std::unordered_map<int, PollState> states_;     // fd - poll状态映射
+    std::vector<int> pendingFds_;                   // 等待（重新）提交poll请求的fd
+
+    static constexpr unsigned kSqEntries = 256;
+    static constexpr unsigned kCqEntries = 16384;
+    static constexpr uint64_t kCancelUserData = UINT64_MAX;
+};
+
+#endif //__IOURINGPOLLER_H__
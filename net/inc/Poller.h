@@ -34,6 +34,7 @@ public:
     // 断言是否处于I/O线程中
     void assertInLoopThread() const;
 
+    // 创建Poller，默认为EpollPoller，设置环境变量TINYSERVER_USE_IOURING时优先使用IoUringPoller
     static PollerPtr createPoller(EventLoop * loop);
 
 protected:
@@ -16,7 +16,7 @@ public:
     void bind(const InetAddress & localAddr);
     // 监听端口
     void listen();
-    // 接收新的连接
+    // 接收新的连接，出现可恢复的错误（EAGAIN、EMFILE等）时返回-1，由调用者根据errno处理
     int accept(InetAddress & peerAddr);
 
     // 半关闭TCP连接
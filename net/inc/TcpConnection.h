@@ -8,6 +8,8 @@
 #include <functional>
 #include "InetAddress.h"
 #include "Buffer.h"
+#include "ChainBuffer.h"
+#include "TimingWheel.h"
 
 class EventLoop;
 class Channel;
@@ -41,11 +43,17 @@ public:
     bool connected() const;
     // 是否已断开连接
     bool disconnected() const;
+    // 发送缓冲中尚未发送的字节数（须在所属IO线程中调用），可配合写完成回调实现背压
+    size_t outputSize() const;
 
     // 发送数据
     void send(const void * message, size_t size);
     // 发送数据
     void send(BufferPtr message);
+    // 发送数据但不拷贝，holder须保证message在发送完毕前有效（发送完毕后释放）
+    void send(const void * message, size_t size, std::shared_ptr<const void> holder);
+    // 使用sendfile()发送文件fd中从offset开始的size字节，holder须保证fd在发送完毕前不被关闭
+    void sendFile(int fd, off_t offset, size_t size, std::shared_ptr<const void> holder);
 
     // 半关闭
     void shutdown();
@@ -59,6 +67,13 @@ public:
     // 是否正在读
     bool isReading() const;
 
+    // 设置是否使用边缘触发（须在connectEstablished()之前调用）
+    // 边缘触发时读写都会一直进行到EAGAIN，并且一直关注可写事件，避免频繁调用epoll_ctl()
+    void setEdgeTriggered(bool enabled);
+
+    // 设置空闲超时时间（秒），超过该时间没有读写则关闭连接，小于等于0表示不启用（须在connectEstablished()之前调用）
+    void setIdleTimeout(double seconds);
+
     // 设置连接回调函数（建立连接和断开连接时都会调用）
     void setConnectionCallback(ConnectionCallback callback);
     // 设置接收完消息回调函数
@@ -87,12 +102,19 @@ private:
     };
 
     void handleRead(TimeStamp receiveTime);
+    // 边缘触发时一次事件读到上限后，由loop在处理完其他事件后继续读取
+    void continueReadInLoop();
     void handleWrite();
     void handleClose();
     void handleError();
+    // 空闲超时（持有weak_ptr，时间轮不会延长TcpConnection的生命周期）
+    static void handleIdleTimeout(std::weak_ptr<TcpConnection> weakConn);
+    // 从时间轮中移除空闲超时条目
+    void removeIdleEntry();
 
-    void sendInLoop(const void * message, size_t size);
+    void sendInLoop(const void * message, size_t size, std::shared_ptr<const void> holder);
     void sendInLoop(std::shared_ptr<Buffer> message);
+    void sendFileInLoop(int fd, off_t offset, size_t size, std::shared_ptr<const void> holder);
     void shutdownInLoop();
     void forceCloseInLoop();
     void startReadInLoop();
@@ -107,6 +129,7 @@ private:
 
     TcpConnectionState state_;          // TcpConnection所处状态
     bool reading_;                      // 标识是否正在读
+    bool edgeTriggered_;                // 是否使用边缘触发
     std::unique_ptr<Socket> socket_;    // TcpConnection持有的Socket对象
     std::unique_ptr<Channel> channel_;  // TcpConnectione持有的Channel对象
 
@@ -116,11 +139,15 @@ private:
     CloseCallback closeCallback_;                   // 连接关闭回调函数
 
     Buffer inputBuffer_;                // 接收缓冲
-    Buffer outputBuffer_;               // 发送缓冲
+    ChainBuffer outputBuffer_;          // 发送缓冲（可引用外部数据，使用writev()输出）
+
+    double idleTimeout_;                // 空闲超时时间（秒）
+    TimingWheel::EntryPtr idleEntry_;   // 时间轮中的空闲超时条目
 
     boost::any context_;                // TCP连接的上下文对象（留给应用层使用）
 
     static const std::string stateStr[];
+    static constexpr Buffer::size_type kMaxReadSizePerEvent = 1024 * 1024;  // 边缘触发时一次事件最多读取的字节数，避免一个连接独占IO线程
 };
 
 
@@ -6,7 +6,9 @@
 #include <string>
 #include <functional>
 #include <unordered_map>
+#include <vector>
 #include "InetAddress.h"
+#include "Mutex.h"
 
 class Acceptor;
 class EventLoop;
@@ -14,6 +16,7 @@ class EventLoopThreadPool;
 class TcpConnection;
 class Buffer;
 class TimeStamp;
+class CountDownLatch;
 
 class TcpServer: public boost::noncopyable {
 public:
@@ -37,6 +40,14 @@ public:
 
     // 设置线程数
     void setThreadNum(int numThreads);
+    // 设置连接的空闲超时时间（秒），小于等于0表示不启用
+    void setIdleTimeout(double seconds);
+    // 设置监听socket和连接是否使用边缘触发，须在start()之前调用
+    void setEdgeTriggered(bool enabled);
+    // 设置每次可读事件最多accept的连接数，须在start()之前调用
+    void setAcceptBatchSize(int batchSize);
+    // 设置是否每个IO线程各自监听同一端口（SO_REUSEPORT），由内核分配连接，省去主线程accept及跨线程移交，须在start()之前调用
+    void setReusePort(bool enabled);
     // 设置线程初始化回调函数
     void setThreadInitCallback(ThreadInitCallback callback);
     // 启动服务器
@@ -50,7 +61,14 @@ public:
     void setWriteCompleteCallback(WriteCompleteCallback callback);
 
 private:
+    // 在IO线程中开始监听
+    static void listenInLoop(std::shared_ptr<Acceptor> acceptor, CountDownLatch * latch);
+    // 在IO线程中停止监听
+    static void closeInLoop(std::shared_ptr<Acceptor> acceptor, CountDownLatch * latch);
+    // 主线程的Acceptor接收到新连接，轮询分配给IO线程
     void handleNewConnection(int sockfd, const InetAddress & peerAddr);
+    // 在ioLoop中创建连接，reuseport模式下由IO线程的Acceptor直接调用
+    void newConnection(EventLoop * ioLoop, int sockfd, const InetAddress & peerAddr);
     void handleRemoveConnection(TcpConnectionPtr conn);
     void removeConnectionInLoop(TcpConnectionPtr conn);
 
@@ -60,6 +78,7 @@ private:
     
     std::unique_ptr<Acceptor> acceptor_;
     std::unique_ptr<EventLoopThreadPool> threadPool_;
+    std::vector<std::shared_ptr<Acceptor>> loopAcceptors_;  // reuseport模式下每个IO线程的Acceptor
     ThreadInitCallback threadInitCallback_;
 
     ConnectionCallback connectionCallback_;
@@ -68,7 +87,15 @@ private:
 
     bool started_;
     int nextConnId_;
+    double idleTimeout_;
+    bool edgeTriggered_;
+    bool reusePort_;
+    int acceptBatchSize_;
+
+    MutexLock mutex_;   // reuseport模式下多个IO线程会同时增删连接
     std::unordered_map<uint64_t, TcpConnectionPtr> connections_;
+
+    static constexpr int kDefaultAcceptBatchSize = 16;
 };
 
 
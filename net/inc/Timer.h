@@ -0,0 +1,41 @@
+#ifndef __TIMER_H__
+#define __TIMER_H__
+
+#include <boost/utility.hpp>
+#include <functional>
+#include <atomic>
+#include "TimeStamp.h"
+
+// Timer封装了定时器任务及其到期时间（仅供TimerQueue使用）
+class Timer: public boost::noncopyable {
+public:
+    using TimerCallback = std::function<void(void)>;
+
+    Timer(TimerCallback callback, TimeStamp expiration, double interval);
+    ~Timer();
+
+    // 执行定时器任务
+    void run() const;
+    // 获取到期时间
+    TimeStamp expiration() const;
+    // 是否为周期性定时器
+    bool repeat() const;
+    // 获取定时器序号
+    int64_t sequence() const;
+    // 重新计算周期性定时器的到期时间
+    void restart(TimeStamp now);
+
+    // 获取已创建的定时器数目
+    static int64_t numCreated();
+
+private:
+    const TimerCallback callback_;  // 定时器任务
+    TimeStamp expiration_;          // 到期时间
+    const double interval_;         // 周期（秒），小于等于0表示一次性定时器
+    const bool repeat_;             // 是否为周期性定时器
+    const int64_t sequence_;        // 全局唯一的序号，用于区分地址相同的不同定时器
+
+    static std::atomic<int64_t> numCreated_;
+};
+
+#endif //__TIMER_H__
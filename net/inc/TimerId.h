@@ -0,0 +1,25 @@
+#ifndef __TIMERID_H__
+#define __TIMERID_H__
+
+#include <cstdint>
+
+class Timer;
+
+// TimerId用于标识一个定时器，仅用于取消定时器
+class TimerId {
+public:
+    TimerId();
+    TimerId(Timer * timer, int64_t sequence);
+    ~TimerId();
+
+    // 是否标识了一个定时器
+    bool valid() const;
+
+private:
+    friend class TimerQueue;
+
+    Timer * timer_;
+    int64_t sequence_;
+};
+
+#endif //__TIMERID_H__
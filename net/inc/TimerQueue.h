@@ -0,0 +1,58 @@
+#ifndef __TIMERQUEUE_H__
+#define __TIMERQUEUE_H__
+
+#include <boost/utility.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <set>
+#include "TimeStamp.h"
+#include "TimerId.h"
+
+class EventLoop;
+class Channel;
+class Timer;
+
+// TimerQueue使用timerfd驱动定时器，定时器按到期时间有序存放在std::set中
+class TimerQueue: public boost::noncopyable {
+public:
+    using TimerCallback = std::function<void(void)>;
+
+    explicit TimerQueue(EventLoop * loop);
+    ~TimerQueue();
+
+    // 添加定时器（线程安全），interval大于0表示周期性定时器
+    TimerId addTimer(TimerCallback callback, TimeStamp when, double interval);
+    // 取消定时器（线程安全）
+    void cancel(TimerId timerId);
+
+private:
+    using Entry             = std::pair<TimeStamp, Timer *>;   // 到期时间 - 定时器
+    using TimerList         = std::set<Entry>;
+    using ActiveTimer       = std::pair<Timer *, int64_t>;     // 定时器 - 序号
+    using ActiveTimerSet    = std::set<ActiveTimer>;
+
+    void addTimerInLoop(Timer * timer);
+    void cancelInLoop(TimerId timerId);
+    // timerfd可读时的回调函数
+    void handleRead();
+    // 取出所有已到期的定时器
+    std::vector<Entry> getExpired(TimeStamp now);
+    // 重新插入周期性定时器，并删除一次性定时器
+    void reset(const std::vector<Entry> & expired, TimeStamp now);
+    // 插入定时器，返回最早到期的定时器是否发生了改变
+    bool insert(Timer * timer);
+    // 重新设置timerfd的到期时间
+    void resetTimerFd(TimeStamp expiration);
+
+    EventLoop * loop_;
+    const int timerFd_;
+    std::unique_ptr<Channel> timerChannel_;
+
+    TimerList timers_;                  // 按到期时间排序的定时器
+    ActiveTimerSet activeTimers_;       // 按地址排序的定时器（与timers_保存相同的定时器）
+    bool callingExpiredTimers_;         // 是否正在执行到期的定时器任务
+    ActiveTimerSet cancelingTimers_;    // 在执行定时器任务时被取消的定时器
+};
+
+#endif //__TIMERQUEUE_H__
@@ -0,0 +1,53 @@
+#ifndef __TIMINGWHEEL_H__
+#define __TIMINGWHEEL_H__
+
+#include <boost/utility.hpp>
+#include <functional>
+#include <vector>
+#include "TimerId.h"
+
+class EventLoop;
+
+// TimingWheel是哈希时间轮，添加、刷新和删除条目均为O(1)，用于管理大量连接的空闲超时
+// 每个tick前进一格，超时时间超过一圈的条目通过圈数rounds区分
+class TimingWheel: public boost::noncopyable {
+public:
+    using TimeoutCallback   = std::function<void(void)>;
+    struct Entry;
+    using EntryPtr          = Entry *;
+
+    TimingWheel(EventLoop * loop, int numBuckets = kDefaultNumBuckets, double tick = kDefaultTick);
+    ~TimingWheel();
+
+    // 添加条目，若timeout秒内没有被touch()则调用callback（条目由调用者通过remove()释放）
+    EntryPtr add(double timeout, TimeoutCallback callback);
+    // 刷新条目，重新开始计时（已超时的条目会被重新加入时间轮）
+    void touch(EntryPtr entry);
+    // 删除并释放条目
+    void remove(EntryPtr entry);
+    // 时间轮中的条目数目
+    size_t size() const;
+
+private:
+    // 每个tick调用一次，处理当前格子中的条目
+    void handleTick();
+    // 将条目挂到对应的格子中
+    void link(EntryPtr entry);
+    // 将条目从所在的格子中摘下
+    void unlink(EntryPtr entry);
+
+    EventLoop * loop_;
+    const double tick_;                 // 每一格的时间（秒）
+    std::vector<EntryPtr> buckets_;     // 每个格子是一个侵入式双向链表
+    size_t cursor_;                     // 当前指向的格子
+    size_t size_;                       // 时间轮中的条目数目
+    bool ticking_;                      // tick定时器是否已启动
+    TimerId tickTimer_;                 // tick定时器
+    bool callingCallbacks_;             // 是否正在执行超时回调
+    std::vector<EntryPtr> removedEntries_;  // 执行超时回调期间被remove()的条目
+
+    static constexpr int kDefaultNumBuckets = 60;
+    static constexpr double kDefaultTick = 1.0;
+};
+
+#endif //__TIMINGWHEEL_H__
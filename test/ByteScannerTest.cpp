@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "ByteScanner.h"
+
+namespace {
+
+// 对齐偏移覆盖AVX2一次比较的全部32种情况，整块之后的尾部长度覆盖0～33
+constexpr int kMaxAlignment = 32;
+constexpr int kMaxTail = 33;
+constexpr int kBlockSizes[] = {0, 64};
+
+// 每个对齐偏移、每个长度、每个匹配位置（包括没有匹配）都与逐字节比较的结果一致
+void expectSameAsScalar(const char * name) {
+    ByteScanner::FindFunction scalar = ByteScanner::implementationOf("scalar");
+    ByteScanner::FindFunction simd = ByteScanner::implementationOf(name);
+    ASSERT_NE(nullptr, scalar);
+    if(simd == nullptr) {
+        GTEST_SKIP() << name << " is not supported by this CPU";
+    }
+
+    alignas(64) char buffer[kMaxAlignment + 64 + kMaxTail + 64];
+    for(int alignment = 0; alignment < kMaxAlignment; ++alignment) {
+        for(int blockSize : kBlockSizes) {
+            for(int tail = 0; tail <= kMaxTail; ++tail) {
+                int size = blockSize + tail;
+                const char * begin = buffer + alignment;
+                const char * end = begin + size;
+                // match为-1表示没有匹配，范围之外的字节也放上匹配字符，检查不会越界
+                for(int match = -1; match < size; ++match) {
+                    ::memset(buffer, 'a', sizeof(buffer));
+                    ::memset(buffer, '\n', alignment);
+                    ::memset(buffer + alignment + size, '\n', sizeof(buffer) - alignment - size);
+                    if(match >= 0) {
+                        buffer[alignment + match] = (match % 2 == 0) ? '\n' : '\xff';
+                    }
+                    ASSERT_EQ(scalar(begin, end, '\n', '\xff'), simd(begin, end, '\n', '\xff'))
+                        << name << " alignment=" << alignment << " size=" << size << " match=" << match;
+                    ASSERT_EQ(scalar(begin, end, '\n', '\n'), simd(begin, end, '\n', '\n'))
+                        << name << " alignment=" << alignment << " size=" << size << " match=" << match;
+                }
+            }
+        }
+    }
+}
+
+}
+
+TEST(ByteScannerTest, Sse2MatchesScalar) {
+    expectSameAsScalar("sse2");
+}
+
+TEST(ByteScannerTest, Avx2MatchesScalar) {
+    expectSameAsScalar("avx2");
+}
+
+TEST(ByteScannerTest, UnknownImplementation) {
+    EXPECT_EQ(nullptr, ByteScanner::implementationOf("avx512"));
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "TestUtil.h"
+
+namespace {
+
+std::string postRequest(const std::string & extraHeaders, const std::string & body) {
+    return "POST /missing HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n" + extraHeaders + "\r\n" + body;
+}
+
+}
+
+// 取值不同的重复Content-Length或Transfer-Encoding无法确定消息体的边界，返回400
+TEST(HttpContextTest, RejectConflictingFramingHeaders) {
+    TempDirectory root;
+    TestHttpServer server(23621, root.path());
+
+    std::string response = roundTrip(server.port(), postRequest("Content-Length: 5\r\nContent-Length: 6\r\n", "hello!"));
+    EXPECT_EQ(400, responseStatus(response));
+
+    response = roundTrip(server.port(), postRequest("Transfer-Encoding: chunked\r\nTransfer-Encoding: identity\r\n", "0\r\n\r\n"));
+    EXPECT_EQ(400, responseStatus(response));
+}
+
+// 取值相同的重复Content-Length照常处理（请求的文件不存在，返回404）
+TEST(HttpContextTest, AcceptIdenticalContentLength) {
+    TempDirectory root;
+    TestHttpServer server(23622, root.path());
+
+    std::string response = roundTrip(server.port(), postRequest("Content-Length: 5\r\ncontent-length: 5\r\n", "hello"));
+    EXPECT_EQ(404, responseStatus(response));
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include "HttpHeader.h"
+
+// 每个常用首部的规范名称、全小写和全大写形式都能查到自己的编号
+TEST(HttpHeaderTest, LookupKnownHeaders) {
+    for(int id = HttpHeader::kUnknown + 1; id < HttpHeader::kNumKnownHeaders; ++id) {
+        std::string name(HttpHeader::name(static_cast<HttpHeader::Id>(id)));
+        EXPECT_EQ(id, HttpHeader::lookup(name)) << name;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        EXPECT_EQ(id, HttpHeader::lookup(name)) << name;
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        EXPECT_EQ(id, HttpHeader::lookup(name)) << name;
+    }
+}
+
+// 长度和首字母与常用首部相同但内容不同的名称不会被误认
+TEST(HttpHeaderTest, LookupUnknownHeaders) {
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup(""));
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup("Dato"));
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup("Content-Lengtx"));
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup("Transfer-Encodin"));
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup("Dnt"));
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup("X-Forwarded-For"));
+    // 首字符不是字母
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup("@ate"));
+    EXPECT_EQ(HttpHeader::kUnknown, HttpHeader::lookup("\xc4" "ate"));
+}
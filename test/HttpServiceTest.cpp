@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "TestUtil.h"
+#include "HttpServer.h"
+
+namespace {
+
+// 足够长且可压缩的文本，保证落在gzip缓存的范围内
+std::string makeText() {
+    std::string text;
+    for(int i = 0; i < 512; ++i) {
+        text += "line " + std::to_string(i) + " of the range test\n";
+    }
+    return text;
+}
+
+void enableGzipCache(HttpServer * server) {
+    server->setGzipCacheSize(1024 * 1024);
+}
+
+std::string getRequest(const std::string & path, const std::string & extraHeaders) {
+    return "GET " + path + " HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n" + extraHeaders + "\r\n";
+}
+
+}
+
+// 命中gzip缓存的区间请求，返回的是gzip编码后内容的区间，必须带上Content-Encoding和Vary
+TEST(HttpServiceTest, RangeOnGzipCacheKeepsContentEncoding) {
+    TempDirectory root;
+    root.writeFile("a.txt", makeText());
+    TestHttpServer server(23601, root.path(), std::bind(&enableGzipCache, std::placeholders::_1));
+
+    std::string full = roundTrip(server.port(), getRequest("/a.txt", "Accept-Encoding: gzip\r\n"));
+    ASSERT_EQ(200, responseStatus(full));
+    ASSERT_EQ("gzip", responseHeader(full, "Content-Encoding"));
+    std::string encoded = responseBody(full);
+    ASSERT_GT(encoded.size(), 100u);
+
+    std::string partial = roundTrip(server.port(), getRequest("/a.txt", "Accept-Encoding: gzip\r\nRange: bytes=10-99\r\n"));
+    EXPECT_EQ(206, responseStatus(partial));
+    EXPECT_EQ("gzip", responseHeader(partial, "Content-Encoding"));
+    EXPECT_EQ("Accept-Encoding", responseHeader(partial, "Vary"));
+    EXPECT_EQ("bytes 10-99/" + std::to_string(encoded.size()), responseHeader(partial, "Content-Range"));
+    EXPECT_EQ(encoded.substr(10, 90), responseBody(partial));
+
+    std::string etag = responseHeader(full, "ETag");
+    ASSERT_FALSE(etag.empty());
+    std::string notModified = roundTrip(server.port(), getRequest("/a.txt", "Accept-Encoding: gzip\r\nIf-None-Match: " + etag + "\r\n"));
+    EXPECT_EQ(304, responseStatus(notModified));
+    EXPECT_EQ("gzip", responseHeader(notModified, "Content-Encoding"));
+    EXPECT_EQ("Accept-Encoding", responseHeader(notModified, "Vary"));
+}
+
+// 不接受gzip的区间请求返回原文件的区间，不带Content-Encoding
+TEST(HttpServiceTest, RangeWithoutGzipIsIdentity) {
+    TempDirectory root;
+    std::string text(makeText());
+    root.writeFile("a.txt", text);
+    TestHttpServer server(23602, root.path(), std::bind(&enableGzipCache, std::placeholders::_1));
+
+    std::string partial = roundTrip(server.port(), getRequest("/a.txt", "Range: bytes=10-99\r\n"));
+    EXPECT_EQ(206, responseStatus(partial));
+    EXPECT_EQ("", responseHeader(partial, "Content-Encoding"));
+    EXPECT_EQ(text.substr(10, 90), responseBody(partial));
+}
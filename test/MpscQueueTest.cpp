@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "MpscQueue.h"
+
+namespace {
+
+constexpr int kNumProducers = 4;
+constexpr int kNumPerProducer = 200000;
+
+void produce(MpscQueue<long> * queue, int producer) {
+    for(int i = 0; i < kNumPerProducer; ++i) {
+        queue->push(static_cast<long>(producer) * kNumPerProducer + i);
+    }
+}
+
+}
+
+// 多个生产者并发push，消费者收到全部元素，且每个生产者的元素保持push的顺序（节点被反复回收复用）
+TEST(MpscQueueTest, MultipleProducersKeepPerProducerOrder) {
+    MpscQueue<long> queue;
+    std::vector<std::thread> producers;
+    for(int p = 0; p < kNumProducers; ++p) {
+        producers.emplace_back(std::bind(&produce, &queue, p));
+    }
+
+    std::vector<int> next(kNumProducers, 0);
+    int received = 0;
+    long value;
+    while(received < kNumProducers * kNumPerProducer) {
+        if(queue.pop(value)) {
+            int p = value / kNumPerProducer;
+            ASSERT_EQ(next[p], value % kNumPerProducer);
+            ++next[p];
+            ++received;
+        }
+    }
+    for(std::thread & producer : producers) {
+        producer.join();
+    }
+    EXPECT_TRUE(queue.empty());
+}
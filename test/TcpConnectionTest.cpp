@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include "TestUtil.h"
+#include "EventLoop.h"
+#include "EventLoopThread.h"
+#include "CountDownLatch.h"
+#include "TcpServer.h"
+#include "TcpConnection.h"
+#include "InetAddress.h"
+#include "Buffer.h"
+#include "TimeStamp.h"
+
+namespace {
+
+// 收到任何数据后发送大量数据并半关闭连接的服务器
+class FloodServer: public boost::noncopyable {
+public:
+    FloodServer(uint16_t port, double idleTimeout)
+        : port_(port)
+        , idleTimeout_(idleTimeout)
+        , payload_(32 * 1024 * 1024, 'x')
+        , closed_(0)
+        , server_()
+        , thread_()
+        , loop_(thread_.startLoop()) {
+        CountDownLatch latch(1);
+        loop_->runInLoop(std::bind(&FloodServer::startInLoop, this, &latch));
+        latch.wait();
+    }
+
+    ~FloodServer() {
+        // 连接和TcpServer随测试进程一起释放，避免在IO线程退出后析构
+        server_.release();
+    }
+
+    int closed() const {
+        return closed_;
+    }
+
+private:
+    void startInLoop(CountDownLatch * latch) {
+        server_.reset(new TcpServer(loop_, InetAddress("127.0.0.1", port_), "FloodServer"));
+        server_->setThreadNum(0);
+        server_->setIdleTimeout(idleTimeout_);
+        server_->setConnectionCallback(std::bind(&FloodServer::handleConnection, this, std::placeholders::_1));
+        server_->setMessageCallback(std::bind(&FloodServer::handleMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        server_->start();
+        latch->countDown();
+    }
+
+    void handleConnection(TcpServer::TcpConnectionPtr conn) {
+        if(conn->disconnected()) {
+            ++closed_;
+        }
+    }
+
+    void handleMessage(TcpServer::TcpConnectionPtr conn, TcpServer::BufferPtr message, TimeStamp) {
+        message->hasRead(message->readableSize());
+        conn->send(payload_.data(), payload_.size());
+        conn->shutdown();
+    }
+
+    const uint16_t port_;
+    const double idleTimeout_;
+    const std::string payload_;
+    std::atomic<int> closed_;
+    std::unique_ptr<TcpServer> server_;
+    EventLoopThread thread_;
+    EventLoop * loop_;
+};
+
+
+// 边缘触发的服务器，记录每次消息回调时接收缓冲中的数据量
+class SinkServer: public boost::noncopyable {
+public:
+    explicit SinkServer(uint16_t port)
+        : port_(port)
+        , received_(0)
+        , maxReceived_(0)
+        , numMessages_(0)
+        , server_()
+        , thread_()
+        , loop_(thread_.startLoop()) {
+        CountDownLatch latch(1);
+        loop_->runInLoop(std::bind(&SinkServer::startInLoop, this, &latch));
+        latch.wait();
+    }
+
+    ~SinkServer() {
+        server_.release();
+    }
+
+    size_t received() const {
+        return received_;
+    }
+
+    size_t maxReceived() const {
+        return maxReceived_;
+    }
+
+private:
+    void startInLoop(CountDownLatch * latch) {
+        server_.reset(new TcpServer(loop_, InetAddress("127.0.0.1", port_), "SinkServer"));
+        server_->setThreadNum(0);
+        server_->setEdgeTriggered(true);
+        server_->setConnectionCallback(std::bind(&SinkServer::handleConnection, this, std::placeholders::_1));
+        server_->setMessageCallback(std::bind(&SinkServer::handleMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        server_->start();
+        latch->countDown();
+    }
+
+    void handleConnection(TcpServer::TcpConnectionPtr) {
+    }
+
+    void handleMessage(TcpServer::TcpConnectionPtr, TcpServer::BufferPtr message, TimeStamp) {
+        if(numMessages_++ == 0) {
+            // 第一次回调时让数据在socket中积压
+            ::usleep(300 * 1000);
+        }
+        size_t size = message->readableSize();
+        if(size > maxReceived_) {
+            maxReceived_ = size;
+        }
+        received_ += size;
+        message->hasRead(size);
+    }
+
+    const uint16_t port_;
+    std::atomic<size_t> received_;
+    std::atomic<size_t> maxReceived_;
+    int numMessages_;
+    std::unique_ptr<TcpServer> server_;
+    EventLoopThread thread_;
+    EventLoop * loop_;
+};
+
+}
+
+// 边缘触发时一次事件读取的数据有上限，剩余的数据在之后继续读取，不会因为不再有边缘通知而丢失
+TEST(TcpConnectionTest, EdgeTriggeredReadIsBoundedPerEvent) {
+    constexpr size_t kSize = 16 * 1024 * 1024;
+    constexpr size_t kMaxReadSizePerEvent = 1024 * 1024;
+    SinkServer server(23612);
+
+    int sockfd = connectLocal(23612);
+    ASSERT_GE(sockfd, 0);
+    std::string payload(kSize, 'x');
+    size_t sent = 0;
+    while(sent < kSize) {
+        ssize_t n = ::write(sockfd, payload.data() + sent, kSize - sent);
+        ASSERT_GT(n, 0);
+        sent += n;
+    }
+
+    for(int i = 0; i < 100 && server.received() < kSize; ++i) {
+        ::usleep(100 * 1000);
+    }
+    EXPECT_EQ(kSize, server.received());
+    // 最后一次读取可能超出上限，但不会超过一次读取的长度
+    EXPECT_LT(server.maxReceived(), 2 * kMaxReadSizePerEvent);
+    ::close(sockfd);
+}
+
+// shutdown()之后对端一直不读，连接停留在kDisconnecting状态，空闲超时后仍然要被关闭
+TEST(TcpConnectionTest, IdleTimeoutReapsDisconnectingConnection) {
+    FloodServer server(23611, 1.0);
+
+    int sockfd = connectLocal(23611);
+    ASSERT_GE(sockfd, 0);
+    ASSERT_EQ(1, ::write(sockfd, "x", 1));
+
+    // 时间轮的精度为1秒，最多等待5秒
+    for(int i = 0; i < 50 && server.closed() == 0; ++i) {
+        ::usleep(100 * 1000);
+    }
+    EXPECT_EQ(1, server.closed());
+    ::close(sockfd);
+}
@@ -0,0 +1,152 @@
+#include "TestUtil.h"
+#include "EventLoop.h"
+#include "HttpServer.h"
+#include "InetAddress.h"
+#include "CountDownLatch.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <strings.h>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+TempDirectory::TempDirectory() {
+    char path[] = "/tmp/tinyserver_test.XXXXXX";
+    char * dir = ::mkdtemp(path);
+    assert(dir != nullptr);
+    path_ = dir;
+}
+
+TempDirectory::~TempDirectory() {
+    DIR * dir = ::opendir(path_.c_str());
+    if(dir != nullptr) {
+        struct dirent * entry;
+        while((entry = ::readdir(dir)) != nullptr) {
+            if(::strcmp(entry->d_name, ".") != 0 && ::strcmp(entry->d_name, "..") != 0) {
+                ::unlink((path_ + "/" + entry->d_name).c_str());
+            }
+        }
+        ::closedir(dir);
+    }
+    ::rmdir(path_.c_str());
+}
+
+const std::string & TempDirectory::path() const {
+    return path_;
+}
+
+void TempDirectory::writeFile(const std::string & name, const std::string & content) {
+    int fd = ::open((path_ + "/" + name).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    ssize_t n = ::write(fd, content.data(), content.size());
+    assert(n == static_cast<ssize_t>(content.size()));
+    (void)n;
+    ::close(fd);
+}
+
+TestHttpServer::TestHttpServer(uint16_t port, const std::string & root, const ConfigureCallback & configure)
+    : port_(port)
+    , root_(root)
+    , configure_(configure)
+    , server_()
+    , thread_()
+    , loop_(thread_.startLoop()) {
+    CountDownLatch latch(1);
+    loop_->runInLoop(std::bind(&TestHttpServer::startInLoop, this, &latch));
+    latch.wait();
+}
+
+TestHttpServer::~TestHttpServer() {
+    CountDownLatch latch(1);
+    loop_->runInLoop(std::bind(&TestHttpServer::stopInLoop, this, &latch));
+    latch.wait();
+}
+
+uint16_t TestHttpServer::port() const {
+    return port_;
+}
+
+void TestHttpServer::startInLoop(CountDownLatch * latch) {
+    server_.reset(new HttpServer(loop_, "TestHttpServer", InetAddress("127.0.0.1", port_), root_));
+    if(configure_) {
+        configure_(server_.get());
+    }
+    // 连接都在IO线程本身处理
+    server_->start(0);
+    latch->countDown();
+}
+
+void TestHttpServer::stopInLoop(CountDownLatch * latch) {
+    // 不再接受新连接，HttpServer本身在IO线程退出后析构
+    server_->stop();
+    latch->countDown();
+}
+
+int connectLocal(uint16_t port) {
+    int sockfd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    assert(sockfd >= 0);
+    struct sockaddr_in addr;
+    ::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(::connect(sockfd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ::close(sockfd);
+        return -1;
+    }
+    return sockfd;
+}
+
+std::string roundTrip(uint16_t port, const std::string & request) {
+    int sockfd = connectLocal(port);
+    if(sockfd < 0) {
+        return std::string();
+    }
+    size_t sent = 0;
+    while(sent < request.size()) {
+        ssize_t n = ::write(sockfd, request.data() + sent, request.size() - sent);
+        if(n <= 0) {
+            break;
+        }
+        sent += n;
+    }
+    std::string response;
+    char buf[16384];
+    ssize_t n;
+    while((n = ::read(sockfd, buf, sizeof(buf))) > 0) {
+        response.append(buf, n);
+    }
+    ::close(sockfd);
+    return response;
+}
+
+std::string responseHeader(const std::string & response, const std::string & name) {
+    size_t headEnd = response.find("\r\n\r\n");
+    size_t pos = response.find("\r\n");
+    while(pos != std::string::npos && pos < headEnd) {
+        size_t lineBegin = pos + 2;
+        size_t lineEnd = response.find("\r\n", lineBegin);
+        size_t colon = response.find(':', lineBegin);
+        if(colon < lineEnd && colon - lineBegin == name.size()
+            && ::strncasecmp(response.data() + lineBegin, name.data(), name.size()) == 0) {
+            size_t valueBegin = response.find_first_not_of(' ', colon + 1);
+            return response.substr(valueBegin, lineEnd - valueBegin);
+        }
+        pos = lineEnd;
+    }
+    return std::string();
+}
+
+int responseStatus(const std::string & response) {
+    // 跳过"HTTP/1.1 "
+    return response.size() > 12 ? std::atoi(response.c_str() + 9) : 0;
+}
+
+std::string responseBody(const std::string & response) {
+    size_t headEnd = response.find("\r\n\r\n");
+    return headEnd == std::string::npos ? std::string() : response.substr(headEnd + 4);
+}
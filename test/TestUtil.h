@@ -0,0 +1,63 @@
+#ifndef __TESTUTIL_H__
+#define __TESTUTIL_H__
+
+#include <boost/utility.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include "EventLoopThread.h"
+
+class EventLoop;
+class HttpServer;
+class CountDownLatch;
+
+// 测试用的临时目录，析构时连同其中的文件一起删除
+class TempDirectory: public boost::noncopyable {
+public:
+    TempDirectory();
+    ~TempDirectory();
+
+    const std::string & path() const;
+    // 在目录中创建文件并写入内容
+    void writeFile(const std::string & name, const std::string & content);
+
+private:
+    std::string path_;
+};
+
+// 在独立的IO线程中运行的HttpServer，测试通过真实的TCP连接访问
+class TestHttpServer: public boost::noncopyable {
+public:
+    using ConfigureCallback = std::function<void(HttpServer *)>;
+
+    // configure在start()之前调用，用于设置缓存等选项
+    TestHttpServer(uint16_t port, const std::string & root, const ConfigureCallback & configure = ConfigureCallback());
+    ~TestHttpServer();
+
+    uint16_t port() const;
+
+private:
+    void startInLoop(CountDownLatch * latch);
+    void stopInLoop(CountDownLatch * latch);
+
+    const uint16_t port_;
+    const std::string root_;
+    ConfigureCallback configure_;
+    // server_须在IO线程退出之后析构，因此声明在thread_之前
+    std::unique_ptr<HttpServer> server_;
+    EventLoopThread thread_;
+    EventLoop * loop_;
+};
+
+// 连接到本机的port端口
+int connectLocal(uint16_t port);
+// 发送一个完整的请求（应带有Connection: close），读取直到服务器关闭连接，返回完整的响应
+std::string roundTrip(uint16_t port, const std::string & request);
+// 取出响应中某个首部的值，不存在时返回空串
+std::string responseHeader(const std::string & response, const std::string & name);
+// 取出响应的状态码
+int responseStatus(const std::string & response);
+// 取出响应的消息体
+std::string responseBody(const std::string & response);
+
+#endif //__TESTUTIL_H__